@@ -0,0 +1,63 @@
+//
+//  DmxReceiverBenchmark.cpp
+//  LightControl
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "DmxReceiver.h"
+#include "LoopbackSender.h"
+
+// Packets per second the receiver thread sustains. A loopback sender sends
+// full Art-Net universes as fast as it can to four subscribed universes and
+// four that are filtered out, the receiver runs on its own single thread.
+namespace {
+    const int DURATION_MS = 2000;
+    const int UNIVERSES = 8;
+}
+
+int main()
+{
+    DmxReceiver receiver(DmxReceiver::Protocol::ArtNet, UNIVERSES / 2);
+    for (int universe = 0; universe < UNIVERSES / 2; universe++) {
+        receiver.subscribe(universe, universe);
+    }
+    if (!receiver.start(0)) {
+        std::printf("Could not bind a port\n");
+        return 1;
+    }
+
+    std::vector<std::vector<uint8_t>> packets;
+    for (int universe = 0; universe < UNIVERSES; universe++) {
+        packets.push_back(LoopbackSender::artNetPacket(universe, std::vector<uint8_t>(DmxReceiver::CHANNELS, universe)));
+    }
+
+    std::atomic<bool> sending(true);
+    uint64_t sent = 0;
+    std::thread sender([&] {
+        LoopbackSender loopback(receiver.getPort());
+        while (sending) {
+            for (auto &packet : packets) {
+                sent += loopback.send(packet) ? 1 : 0;
+            }
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(DURATION_MS));
+    sending = false;
+    sender.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    receiver.stop();
+
+    uint64_t received = receiver.getReceivedCount();
+    uint64_t accepted = receiver.getPacketCount();
+    std::printf("sent %llu, received %llu, accepted %llu packets\n", (unsigned long long) sent,
+                (unsigned long long) received, (unsigned long long) accepted);
+    std::printf("%.0f packets/s received, %.0f packets/s accepted\n", received / seconds, accepted / seconds);
+    return 0;
+}
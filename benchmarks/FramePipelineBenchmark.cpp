@@ -0,0 +1,85 @@
+//
+//  FramePipelineBenchmark.cpp
+//  LightControl
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "FramePipeline.h"
+
+// Frame time of a 64 universe pipeline at 1, 2, 4 and 8 worker threads. The
+// stages stand in for merge, effects and curves. The frames of every thread
+// count are compared with the single threaded one, a mismatch fails the run.
+namespace {
+    const int UNIVERSES = 64;
+    const int BLOCK_SIZE = 128;
+    const int WARMUP_TICKS = 50;
+    const int TICKS = 500;
+
+    void addStages(FramePipeline &pipeline, std::vector<int> &merged)
+    {
+        pipeline.addStage("merge", [&merged](int universe, int start, int end, int *values) {
+            const int *other = &merged[universe * FramePipeline::CHANNELS_PER_UNIVERSE];
+            for (int i = start; i < end; i++) {
+                values[i] = std::max(values[i], other[i]);
+            }
+        });
+        pipeline.addStage("effect", [](int universe, int start, int end, int *values) {
+            for (int i = start; i < end; i++) {
+                values[i] = (int) (values[i] * (0.5f + 0.5f * std::sin(universe * 0.1f + i * 0.05f)));
+            }
+        });
+        pipeline.addStage("curve", [](int universe, int start, int end, int *values) {
+            for (int i = start; i < end; i++) {
+                values[i] = (int) (255.f * std::pow(values[i] / 255.f, 2.2f));
+            }
+        });
+    }
+}
+
+int main()
+{
+    std::vector<int> merged(UNIVERSES * FramePipeline::CHANNELS_PER_UNIVERSE);
+    for (size_t i = 0; i < merged.size(); i++) {
+        merged[i] = (int) ((i * 13) % 256);
+    }
+
+    std::vector<int> reference;
+    bool deterministic = true;
+    std::printf("%d universes, block size %d, %d ticks\n", UNIVERSES, BLOCK_SIZE, TICKS);
+    for (int threads : {1, 2, 4, 8}) {
+        FramePipeline pipeline(UNIVERSES, threads);
+        pipeline.setBlockSize(BLOCK_SIZE);
+        for (int universe = 0; universe < UNIVERSES; universe++) {
+            for (int i = 0; i < FramePipeline::CHANNELS_PER_UNIVERSE; i++) {
+                pipeline.getInput(universe)[i] = (universe * 31 + i * 7) % 256;
+            }
+        }
+        addStages(pipeline, merged);
+
+        for (int tick = 0; tick < WARMUP_TICKS; tick++) {
+            pipeline.process();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < TICKS; tick++) {
+            pipeline.process();
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<int> frame;
+        for (int universe = 0; universe < UNIVERSES; universe++) {
+            const int *output = pipeline.getOutput(universe);
+            frame.insert(frame.end(), output, output + FramePipeline::CHANNELS_PER_UNIVERSE);
+        }
+        if (reference.empty()) {
+            reference = frame;
+        }
+        bool same = frame == reference;
+        deterministic = deterministic && same;
+        std::printf("%d thread(s): %.3f ms per frame%s\n", threads, elapsed / TICKS, same ? "" : " (output differs)");
+    }
+    return deterministic ? 0 : 1;
+}
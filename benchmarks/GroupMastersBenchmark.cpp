@@ -0,0 +1,86 @@
+//
+//  GroupMastersBenchmark.cpp
+//  LightControl
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "GroupMasters.h"
+
+// Submaster moves and master application with thousands of nested groups:
+// 8 areas with 16 washes each, every wash holding 32 fixture groups of four
+// channels, which fills 32 universes. Fixture moves only touch one fixture,
+// area moves recompute a whole area. Applying the masters is timed per frame
+// of all universes.
+namespace {
+    const int UNIVERSES = 32;
+    const int CHANNELS = 512;
+    const int AREAS = 8;
+    const int WASHES_PER_AREA = 16;
+    const int FIXTURES_PER_WASH = 32;
+    const int CHANNELS_PER_FIXTURE = 4;
+    const int MOVES = 200000;
+    const int FRAMES = 2000;
+
+    template<typename Function>
+    double timeMicroseconds(int count, Function function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            function(i);
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / count;
+    }
+}
+
+int main()
+{
+    GroupMasters masters(UNIVERSES);
+    std::vector<int> areas, washes, fixtures;
+    int slot = 0;
+    for (int area = 0; area < AREAS; area++) {
+        areas.push_back(masters.addGroup("area", -1, GroupMasters::Mode::Scaling));
+        for (int wash = 0; wash < WASHES_PER_AREA; wash++) {
+            washes.push_back(masters.addGroup("wash", areas.back(), GroupMasters::Mode::Inhibitive));
+            for (int fixture = 0; fixture < FIXTURES_PER_WASH; fixture++) {
+                fixtures.push_back(masters.addGroup("fixture", washes.back(), GroupMasters::Mode::Scaling));
+                for (int channel = 0; channel < CHANNELS_PER_FIXTURE; channel++, slot++) {
+                    masters.addChannel(fixtures.back(), slot / CHANNELS, slot % CHANNELS + 1);
+                }
+            }
+        }
+    }
+    std::printf("%zu groups, %d grouped channels over %d universes\n", masters.getGroupCount(),
+                slot, UNIVERSES);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> level(0.f, 1.f);
+    double fixtureMove = timeMicroseconds(MOVES, [&](int i) {
+        masters.setLevel(fixtures[random() % fixtures.size()], level(random));
+    });
+    double washMove = timeMicroseconds(MOVES / 10, [&](int i) {
+        masters.setLevel(washes[random() % washes.size()], level(random));
+    });
+    double areaMove = timeMicroseconds(MOVES / 100, [&](int i) {
+        masters.setLevel(areas[random() % areas.size()], level(random));
+    });
+    std::printf("fixture submaster move: %.3f us\n", fixtureMove);
+    std::printf("wash submaster move: %.3f us\n", washMove);
+    std::printf("area submaster move: %.3f us\n", areaMove);
+
+    std::vector<int> values(UNIVERSES * CHANNELS, 255);
+    masters.setGrandMaster(0.8f);
+    long checksum = 0;
+    double apply = timeMicroseconds(FRAMES, [&](int i) {
+        std::fill(values.begin(), values.end(), 255);
+        for (int universe = 0; universe < UNIVERSES; universe++) {
+            masters.applyTo(universe, 0, CHANNELS, &values[universe * CHANNELS]);
+        }
+        checksum += values[i % values.size()];
+    });
+    std::printf("apply masters to %d universes: %.3f us per frame (checksum %ld)\n", UNIVERSES, apply, checksum);
+    return 0;
+}
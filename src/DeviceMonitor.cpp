@@ -0,0 +1,194 @@
+//
+//  DeviceMonitor.cpp
+//  LightControl
+//
+
+#include "DeviceMonitor.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const int WAIT_INTERVAL_MS = 250;
+    // Udev creates the node before the permissions and symlinks are in place.
+    const int SETTLE_TIME_MS = 200;
+    const int POLL_INTERVAL_MS = 1000;
+}
+
+DeviceMonitor::DeviceMonitor(Enumerator enumerator)
+:mEnumerator(enumerator), mRunning(false), mRevision(0), mRescanRequested(false)
+{
+}
+
+DeviceMonitor::~DeviceMonitor()
+{
+    stop();
+}
+
+void DeviceMonitor::start()
+{
+    if (mRunning) {
+        return;
+    }
+    mRunning = true;
+    mThread = std::thread(&DeviceMonitor::monitorLoop, this);
+}
+
+void DeviceMonitor::stop()
+{
+    if (!mRunning) {
+        return;
+    }
+    mRunning = false;
+    mThread.join();
+}
+
+void DeviceMonitor::requestRescan()
+{
+    mRescanRequested = true;
+}
+
+void DeviceMonitor::notifyRemoved(const std::string &node)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRemovedNodes.push_back(node);
+    }
+    requestRescan();
+}
+
+uint64_t DeviceMonitor::getRevision()
+{
+    return mRevision;
+}
+
+std::vector<std::string> DeviceMonitor::getDevices()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDevices;
+}
+
+std::vector<DeviceMonitor::Event> DeviceMonitor::pollEvents()
+{
+    std::vector<Event> events;
+    std::lock_guard<std::mutex> lock(mMutex);
+    events.swap(mEvents);
+    return events;
+}
+
+std::mutex &DeviceMonitor::getEnumerationMutex()
+{
+    return mEnumerationMutex;
+}
+
+void DeviceMonitor::monitorLoop()
+{
+    rescan();
+#ifdef __linux__
+    const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+    int notifier = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifier >= 0 && inotify_add_watch(notifier, "/dev", mask) < 0) {
+        // Without a watch on /dev nothing would ever trigger a rescan, so fall back to polling.
+        close(notifier);
+        notifier = -1;
+    }
+    if (notifier >= 0) {
+        int byIdWatch = inotify_add_watch(notifier, "/dev/serial/by-id", mask);
+        alignas(inotify_event) char buffer[4096];
+        pollfd descriptor;
+        descriptor.fd = notifier;
+        descriptor.events = POLLIN;
+        while (mRunning) {
+            descriptor.revents = 0;
+            if (poll(&descriptor, 1, WAIT_INTERVAL_MS) <= 0) {
+                if (mRescanRequested.exchange(false)) {
+                    rescan();
+                }
+                continue;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_TIME_MS));
+            ssize_t size;
+            while ((size = read(notifier, buffer, sizeof(buffer))) > 0) {
+                for (char *position = buffer; position < buffer + size; ) {
+                    const inotify_event *event = reinterpret_cast<const inotify_event *>(position);
+                    if (event->wd == byIdWatch && (event->mask & IN_IGNORED)) {
+                        byIdWatch = -1;
+                    }
+                    if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) && event->len > 0) {
+                        notifyRemoved(event->name);
+                    }
+                    position += sizeof(inotify_event) + event->len;
+                }
+            }
+            if (byIdWatch < 0) {
+                // Udev removes the by-id directory with the last serial device and creates it again
+                // for the next one, which also shows up as a new node in /dev.
+                byIdWatch = inotify_add_watch(notifier, "/dev/serial/by-id", mask);
+            }
+            mRescanRequested = false;
+            rescan();
+        }
+        close(notifier);
+        return;
+    }
+#endif
+    auto lastScan = std::chrono::steady_clock::now();
+    while (mRunning) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_INTERVAL_MS));
+        if (mRescanRequested.exchange(false)
+            || std::chrono::steady_clock::now() - lastScan >= std::chrono::milliseconds(POLL_INTERVAL_MS)) {
+            rescan();
+            lastScan = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+void DeviceMonitor::rescan()
+{
+    // Taken before enumerating, a node removed during the scan is picked up by the next one.
+    std::vector<std::string> removedNodes;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        removedNodes.swap(mRemovedNodes);
+    }
+    std::vector<std::string> devices;
+    {
+        std::lock_guard<std::mutex> lock(mEnumerationMutex);
+        devices = mEnumerator();
+    }
+    std::sort(devices.begin(), devices.end());
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<std::string> changed;
+    if (!removedNodes.empty()) {
+        // Devices in both lists whose node was removed in between have been replugged.
+        std::set_intersection(devices.begin(), devices.end(), mDevices.begin(), mDevices.end(), std::back_inserter(changed));
+        for (auto &device : changed) {
+            std::string node = device.substr(device.find_last_of('/') + 1);
+            if (std::find(removedNodes.begin(), removedNodes.end(), node) != removedNodes.end()) {
+                mEvents.push_back({Event::Removed, device});
+                mEvents.push_back({Event::Arrived, device});
+            }
+        }
+        changed.clear();
+    }
+    if (devices == mDevices) {
+        return;
+    }
+    std::set_difference(devices.begin(), devices.end(), mDevices.begin(), mDevices.end(), std::back_inserter(changed));
+    for (auto &device : changed) {
+        mEvents.push_back({Event::Arrived, device});
+    }
+    changed.clear();
+    std::set_difference(mDevices.begin(), mDevices.end(), devices.begin(), devices.end(), std::back_inserter(changed));
+    for (auto &device : changed) {
+        mEvents.push_back({Event::Removed, device});
+    }
+    mDevices.swap(devices);
+    mRevision++;
+}
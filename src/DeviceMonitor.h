@@ -0,0 +1,72 @@
+//
+//  DeviceMonitor.h
+//  LightControl
+//
+
+#ifndef DeviceMonitor_h
+#define DeviceMonitor_h
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Keeps a cached list of serial devices up to date on a background thread, so
+// nobody has to enumerate ports on the main thread. On Linux the thread sleeps
+// on inotify watches of /dev and /dev/serial/by-id and only enumerates when a
+// node comes or goes, elsewhere it enumerates once per second. Arrivals and
+// removals are queued and picked up with pollEvents(). A device that is
+// unplugged and plugged in again between two scans is still reported removed
+// and arrived, because the deleted node names are remembered. requestRescan() makes
+// the thread enumerate on its next wake up without waiting for a change.
+class DeviceMonitor {
+public:
+    typedef std::function<std::vector<std::string>()> Enumerator;
+
+    struct Event {
+        enum Type { Arrived, Removed };
+        Type mType;
+        std::string mDevice;
+    };
+
+    explicit DeviceMonitor(Enumerator enumerator);
+    ~DeviceMonitor();
+
+    void start();
+    void stop();
+    void requestRescan();
+    // Tells the monitor a node with this name went away. When it's listed again by the
+    // next scan, the device was replugged in between and is reported removed and arrived.
+    void notifyRemoved(const std::string &node);
+
+    // Increases every time the device list changes.
+    uint64_t getRevision();
+    std::vector<std::string> getDevices();
+    std::vector<Event> pollEvents();
+
+    // Held while the enumerator runs. Code that opens or closes the devices on
+    // another thread takes it as well, since the serial enumeration keeps
+    // static state that isn't safe to use concurrently.
+    std::mutex &getEnumerationMutex();
+
+private:
+    Enumerator mEnumerator;
+    std::thread mThread;
+    std::atomic<bool> mRunning;
+    std::atomic<uint64_t> mRevision;
+    std::atomic<bool> mRescanRequested;
+    std::mutex mEnumerationMutex;
+
+    std::mutex mMutex;
+    std::vector<std::string> mDevices;
+    std::vector<Event> mEvents;
+    std::vector<std::string> mRemovedNodes;
+
+    void monitorLoop();
+    void rescan();
+};
+
+#endif /* DeviceMonitor_h */
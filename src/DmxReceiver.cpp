@@ -0,0 +1,417 @@
+//
+//  DmxReceiver.cpp
+//  LightControl
+//
+
+#include "DmxReceiver.h"
+#include <algorithm>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    const size_t MAX_PACKET_SIZE = 640;
+    const int RECEIVE_BATCH = 32;
+    const int POLL_TIMEOUT_MS = 100;
+
+    const uint8_t ARTNET_ID[8] = {'A', 'r', 't', '-', 'N', 'e', 't', 0};
+    const uint16_t ARTNET_OP_DMX = 0x5000;
+    const size_t ARTNET_HEADER_SIZE = 18;
+
+    const uint8_t SACN_ID[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    const uint32_t SACN_VECTOR_ROOT_DATA = 0x00000004;
+    const uint32_t SACN_VECTOR_FRAMING_DATA = 0x00000002;
+    const uint8_t SACN_VECTOR_DMP_SET_PROPERTY = 0x02;
+    const uint8_t SACN_OPTION_PREVIEW = 0x80;
+    const uint8_t SACN_OPTION_TERMINATED = 0x40;
+    const size_t SACN_HEADER_SIZE = 126;
+
+    inline uint16_t readUint16(const uint8_t *data)
+    {
+        return (uint16_t) ((data[0] << 8) | data[1]);
+    }
+
+    inline uint32_t readUint32(const uint8_t *data)
+    {
+        return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+    }
+}
+
+DmxReceiver::DmxReceiver(Protocol protocol, int localUniverseCount)
+:mProtocol(protocol), mSocket(-1), mRunning(false), mPacketCount(0), mReceivedCount(0),
+ mSubscriptions(65536, -1), mSourceTimeout(std::chrono::milliseconds(2500)), mDefaultPriority(100),
+ mSnapshots(std::max(localUniverseCount, 1))
+{
+    for (auto &snapshot : mSnapshots) {
+        snapshot.mActive = false;
+        std::fill_n(snapshot.mValues, CHANNELS, 0);
+    }
+}
+
+DmxReceiver::~DmxReceiver()
+{
+    stop();
+}
+
+bool DmxReceiver::start()
+{
+    return start(mProtocol == Protocol::ArtNet ? (int) ARTNET_PORT : (int) SACN_PORT);
+}
+
+bool DmxReceiver::start(int port)
+{
+    if (mRunning) {
+        return true;
+    }
+    mSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (mSocket < 0) {
+        return false;
+    }
+    int enable = 1;
+    setsockopt(mSocket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#ifdef SO_REUSEPORT
+    setsockopt(mSocket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+#endif
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(mSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        close(mSocket);
+        mSocket = -1;
+        return false;
+    }
+    if (mProtocol == Protocol::Sacn) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int universe = 0; universe < (int) mSubscriptions.size(); universe++) {
+            if (mSubscriptions[universe] >= 0) {
+                joinMulticast(universe, true);
+            }
+        }
+    }
+    mRunning = true;
+    mThread = std::thread(&DmxReceiver::receiveLoop, this);
+    return true;
+}
+
+void DmxReceiver::stop()
+{
+    if (!mRunning) {
+        return;
+    }
+    mRunning = false;
+    mThread.join();
+    close(mSocket);
+    mSocket = -1;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSources.clear();
+}
+
+bool DmxReceiver::isRunning()
+{
+    return mRunning;
+}
+
+int DmxReceiver::getPort()
+{
+    if (mSocket < 0) {
+        return -1;
+    }
+    sockaddr_in address;
+    socklen_t size = sizeof(address);
+    if (getsockname(mSocket, reinterpret_cast<sockaddr *>(&address), &size) < 0) {
+        return -1;
+    }
+    return ntohs(address.sin_port);
+}
+
+void DmxReceiver::subscribe(int networkUniverse, int localUniverse)
+{
+    if (networkUniverse < 0 || networkUniverse >= (int) mSubscriptions.size()
+        || localUniverse < 0 || localUniverse >= (int) mSnapshots.size()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mSubscriptions[networkUniverse] < 0 && mRunning && mProtocol == Protocol::Sacn) {
+        joinMulticast(networkUniverse, true);
+    }
+    mSubscriptions[networkUniverse] = localUniverse;
+}
+
+void DmxReceiver::unsubscribe(int networkUniverse)
+{
+    if (networkUniverse < 0 || networkUniverse >= (int) mSubscriptions.size()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mSubscriptions[networkUniverse] >= 0 && mRunning && mProtocol == Protocol::Sacn) {
+        joinMulticast(networkUniverse, false);
+    }
+    mSubscriptions[networkUniverse] = -1;
+    mSources.erase(std::remove_if(mSources.begin(), mSources.end(), [&](const SourceBuffer &source) {
+        return source.mUniverse == networkUniverse;
+    }), mSources.end());
+}
+
+void DmxReceiver::setSourceTimeout(double seconds)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSourceTimeout = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void DmxReceiver::setDefaultPriority(int priority)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDefaultPriority = priority;
+}
+
+void DmxReceiver::update()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto now = Clock::now();
+    mSources.erase(std::remove_if(mSources.begin(), mSources.end(), [&](const SourceBuffer &source) {
+        return source.mTerminated || now - source.mLastSeen > mSourceTimeout;
+    }), mSources.end());
+
+    for (int local = 0; local < (int) mSnapshots.size(); local++) {
+        Snapshot &snapshot = mSnapshots[local];
+        snapshot.mActive = false;
+        int topPriority = -1;
+        for (auto &source : mSources) {
+            if (mSubscriptions[source.mUniverse] == local) {
+                topPriority = std::max(topPriority, source.mPriority);
+            }
+        }
+        if (topPriority < 0) {
+            continue;
+        }
+        snapshot.mActive = true;
+        std::fill_n(snapshot.mValues, CHANNELS, 0);
+        for (auto &source : mSources) {
+            if (mSubscriptions[source.mUniverse] != local || source.mPriority != topPriority) {
+                continue;
+            }
+            for (int i = 0; i < source.mLength; i++) {
+                snapshot.mValues[i] = std::max(snapshot.mValues[i], source.mValues[i]);
+            }
+        }
+    }
+}
+
+void DmxReceiver::mergeInto(int localUniverse, int start, int end, int *values)
+{
+    if (localUniverse >= (int) mSnapshots.size() || !mSnapshots[localUniverse].mActive) {
+        return;
+    }
+    const uint8_t *received = mSnapshots[localUniverse].mValues;
+    for (int i = start; i < end; i++) {
+        values[i] = std::max(values[i], (int) received[i]);
+    }
+}
+
+uint64_t DmxReceiver::getPacketCount()
+{
+    return mPacketCount;
+}
+
+uint64_t DmxReceiver::getReceivedCount()
+{
+    return mReceivedCount;
+}
+
+std::vector<DmxReceiver::SourceInfo> DmxReceiver::getSources()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<SourceInfo> sources;
+    for (auto &source : mSources) {
+        sources.push_back({source.mName, source.mUniverse, source.mPriority});
+    }
+    return sources;
+}
+
+void DmxReceiver::receiveLoop()
+{
+    // The receive buffers live as long as the thread and are parsed in place.
+    std::vector<uint8_t> buffers(RECEIVE_BATCH * MAX_PACKET_SIZE);
+    sockaddr_in senders[RECEIVE_BATCH];
+#ifdef __linux__
+    mmsghdr messages[RECEIVE_BATCH];
+    iovec vectors[RECEIVE_BATCH];
+    for (int i = 0; i < RECEIVE_BATCH; i++) {
+        vectors[i].iov_base = &buffers[i * MAX_PACKET_SIZE];
+        vectors[i].iov_len = MAX_PACKET_SIZE;
+    }
+#endif
+
+    pollfd descriptor;
+    descriptor.fd = mSocket;
+    descriptor.events = POLLIN;
+    while (mRunning) {
+        descriptor.revents = 0;
+        if (poll(&descriptor, 1, POLL_TIMEOUT_MS) <= 0 || !(descriptor.revents & POLLIN)) {
+            continue;
+        }
+#ifdef __linux__
+        for (int i = 0; i < RECEIVE_BATCH; i++) {
+            std::memset(&messages[i].msg_hdr, 0, sizeof(msghdr));
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &senders[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+        int received = recvmmsg(mSocket, messages, RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+        if (received <= 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int i = 0; i < received; i++) {
+            handlePacket(&buffers[i * MAX_PACKET_SIZE], messages[i].msg_len, &senders[i]);
+        }
+#else
+        int received = 0;
+        size_t sizes[RECEIVE_BATCH];
+        while (received < RECEIVE_BATCH) {
+            socklen_t senderSize = sizeof(sockaddr_in);
+            ssize_t size = recvfrom(mSocket, &buffers[received * MAX_PACKET_SIZE], MAX_PACKET_SIZE, MSG_DONTWAIT,
+                                    reinterpret_cast<sockaddr *>(&senders[received]), &senderSize);
+            if (size <= 0) {
+                break;
+            }
+            sizes[received++] = size;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int i = 0; i < received; i++) {
+            handlePacket(&buffers[i * MAX_PACKET_SIZE], sizes[i], &senders[i]);
+        }
+#endif
+    }
+}
+
+void DmxReceiver::handlePacket(const uint8_t *data, size_t size, const void *senderAddress)
+{
+    mReceivedCount++;
+    bool accepted = mProtocol == Protocol::ArtNet ? parseArtNet(data, size, senderAddress) : parseSacn(data, size);
+    if (accepted) {
+        mPacketCount++;
+    }
+}
+
+bool DmxReceiver::parseArtNet(const uint8_t *data, size_t size, const void *senderAddress)
+{
+    if (size < ARTNET_HEADER_SIZE || std::memcmp(data, ARTNET_ID, sizeof(ARTNET_ID)) != 0) {
+        return false;
+    }
+    // The op code is the only little endian field.
+    if ((data[8] | (data[9] << 8)) != ARTNET_OP_DMX) {
+        return false;
+    }
+    int universe = (data[14] | (data[15] << 8)) & 0x7fff;
+    if (mSubscriptions[universe] < 0) {
+        return false;
+    }
+    int length = std::min((int) readUint16(data + 16), (int) CHANNELS);
+    if (length > (int) (size - ARTNET_HEADER_SIZE)) {
+        return false;
+    }
+
+    // Art-Net has no source id, so the sender address is used instead.
+    const sockaddr_in *sender = static_cast<const sockaddr_in *>(senderAddress);
+    SourceId id;
+    id.fill(0);
+    std::memcpy(id.data(), &sender->sin_addr, sizeof(sender->sin_addr));
+    std::memcpy(id.data() + sizeof(sender->sin_addr), &sender->sin_port, sizeof(sender->sin_port));
+    SourceBuffer *source = findSource(id, universe);
+    if (source->mName.empty()) {
+        char name[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &sender->sin_addr, name, sizeof(name));
+        source->mName = name;
+    }
+    source->mPriority = mDefaultPriority;
+    source->mLength = length;
+    source->mLastSeen = Clock::now();
+    std::memcpy(source->mValues, data + ARTNET_HEADER_SIZE, length);
+    return true;
+}
+
+bool DmxReceiver::parseSacn(const uint8_t *data, size_t size)
+{
+    if (size < SACN_HEADER_SIZE || std::memcmp(data + 4, SACN_ID, sizeof(SACN_ID)) != 0) {
+        return false;
+    }
+    if (readUint32(data + 18) != SACN_VECTOR_ROOT_DATA || readUint32(data + 40) != SACN_VECTOR_FRAMING_DATA) {
+        return false;
+    }
+    int universe = readUint16(data + 113);
+    if (mSubscriptions[universe] < 0) {
+        return false;
+    }
+    uint8_t options = data[112];
+    if ((options & SACN_OPTION_PREVIEW) || data[117] != SACN_VECTOR_DMP_SET_PROPERTY) {
+        return false;
+    }
+    // Only the null start code carries dimmer data, the property count includes the start code.
+    int propertyCount = readUint16(data + 123);
+    if (data[125] != 0 || propertyCount < 1) {
+        return false;
+    }
+    int length = std::min(propertyCount - 1, (int) CHANNELS);
+    if (length > (int) (size - SACN_HEADER_SIZE)) {
+        return false;
+    }
+
+    SourceId id;
+    std::memcpy(id.data(), data + 22, id.size());
+    SourceBuffer *source = findSource(id, universe);
+    int sequence = data[111];
+    if (source->mSequence >= 0) {
+        // Out of order packets are dropped, big jumps back mean the source restarted (E1.31 6.7.2).
+        int8_t difference = (int8_t) (sequence - source->mSequence);
+        if (difference <= 0 && difference > -20) {
+            return false;
+        }
+    }
+    if (source->mName.empty()) {
+        const char *name = reinterpret_cast<const char *>(data + 44);
+        source->mName = std::string(name, strnlen(name, 64));
+    }
+    source->mSequence = sequence;
+    source->mPriority = data[108];
+    source->mTerminated = (options & SACN_OPTION_TERMINATED) != 0;
+    source->mLength = length;
+    source->mLastSeen = Clock::now();
+    std::memcpy(source->mValues, data + SACN_HEADER_SIZE, length);
+    return true;
+}
+
+DmxReceiver::SourceBuffer *DmxReceiver::findSource(const SourceId &id, int universe)
+{
+    for (auto &source : mSources) {
+        if (source.mUniverse == universe && source.mId == id) {
+            return &source;
+        }
+    }
+    SourceBuffer source;
+    source.mId = id;
+    source.mUniverse = universe;
+    source.mPriority = mDefaultPriority;
+    source.mLength = 0;
+    source.mSequence = -1;
+    source.mTerminated = false;
+    std::fill_n(source.mValues, CHANNELS, 0);
+    mSources.push_back(source);
+    return &mSources.back();
+}
+
+void DmxReceiver::joinMulticast(int networkUniverse, bool join)
+{
+    // sACN universes are sent to 239.255.<universe high byte>.<universe low byte>.
+    ip_mreq request;
+    request.imr_multiaddr.s_addr = htonl(0xefff0000 | (networkUniverse & 0xffff));
+    request.imr_interface.s_addr = htonl(INADDR_ANY);
+    setsockopt(mSocket, IPPROTO_IP, join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP, &request, sizeof(request));
+}
@@ -0,0 +1,109 @@
+//
+//  DmxReceiver.h
+//  LightControl
+//
+
+#ifndef DmxReceiver_h
+#define DmxReceiver_h
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Receives dmx from other consoles over Art-Net or sACN (E1.31) on a
+// background thread. Packets are parsed in place from a reusable receive
+// buffer and dropped on the universe number before the payload is read.
+// Every sender gets its own universe buffer. update() is called once per tick
+// on the main thread and merges the live sources into a snapshot per local
+// universe: the highest priority wins and sources at the same priority are
+// merged highest takes precedence. mergeInto() is safe to use as a frame
+// pipeline stage because it only reads that snapshot.
+class DmxReceiver {
+public:
+    enum class Protocol { ArtNet, Sacn };
+
+    static const int ARTNET_PORT = 6454;
+    static const int SACN_PORT = 5568;
+    static const int CHANNELS = 512;
+
+    struct SourceInfo {
+        std::string mName;
+        int mUniverse;
+        int mPriority;
+    };
+
+    DmxReceiver(Protocol protocol, int localUniverseCount);
+    ~DmxReceiver();
+
+    bool start();
+    bool start(int port);
+    void stop();
+    bool isRunning();
+    // The bound port, useful after start(0).
+    int getPort();
+
+    void subscribe(int networkUniverse, int localUniverse);
+    void unsubscribe(int networkUniverse);
+    void setSourceTimeout(double seconds);
+    // Art-Net has no priority, its sources all use this one.
+    void setDefaultPriority(int priority);
+
+    void update();
+    void mergeInto(int localUniverse, int start, int end, int *values);
+
+    // Accepted packets, and every datagram read including the filtered ones.
+    uint64_t getPacketCount();
+    uint64_t getReceivedCount();
+    std::vector<SourceInfo> getSources();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::array<uint8_t, 16> SourceId;
+
+    struct SourceBuffer {
+        SourceId mId;
+        int mUniverse;
+        int mPriority;
+        int mLength;
+        int mSequence;
+        bool mTerminated;
+        Clock::time_point mLastSeen;
+        std::string mName;
+        uint8_t mValues[CHANNELS];
+    };
+
+    struct Snapshot {
+        bool mActive;
+        uint8_t mValues[CHANNELS];
+    };
+
+    Protocol mProtocol;
+    int mSocket;
+    std::thread mThread;
+    std::atomic<bool> mRunning;
+    std::atomic<uint64_t> mPacketCount;
+    std::atomic<uint64_t> mReceivedCount;
+
+    std::mutex mMutex;
+    // Network universe -> local universe, -1 when not subscribed.
+    std::vector<int> mSubscriptions;
+    std::vector<SourceBuffer> mSources;
+    Clock::duration mSourceTimeout;
+    int mDefaultPriority;
+
+    std::vector<Snapshot> mSnapshots;
+
+    void receiveLoop();
+    void handlePacket(const uint8_t *data, size_t size, const void *senderAddress);
+    bool parseArtNet(const uint8_t *data, size_t size, const void *senderAddress);
+    bool parseSacn(const uint8_t *data, size_t size);
+    SourceBuffer *findSource(const SourceId &id, int universe);
+    void joinMulticast(int networkUniverse, bool join);
+};
+
+#endif /* DmxReceiver_h */
@@ -0,0 +1,88 @@
+//
+//  FramePipeline.cpp
+//  LightControl
+//
+
+#include "FramePipeline.h"
+#include <algorithm>
+
+FramePipeline::FramePipeline(int universeCount, int threadCount)
+:mUniverseCount(std::max(universeCount, 1)), mBlockSize(CHANNELS_PER_UNIVERSE),
+ mInput(mUniverseCount * CHANNELS_PER_UNIVERSE, 0), mOutput(mUniverseCount * CHANNELS_PER_UNIVERSE, 0),
+ mPool(new WorkStealingPool(threadCount))
+{
+    buildTasks();
+}
+
+void FramePipeline::addStage(std::string name, Stage stage)
+{
+    mStages.push_back({name, stage});
+}
+
+void FramePipeline::removeStage(std::string name)
+{
+    mStages.erase(std::remove_if(mStages.begin(), mStages.end(), [&](const NamedStage &stage) {
+        return stage.mName == name;
+    }), mStages.end());
+}
+
+void FramePipeline::setBlockSize(int channels)
+{
+    mBlockSize = std::min(std::max(channels, 1), (int) CHANNELS_PER_UNIVERSE);
+    buildTasks();
+}
+
+void FramePipeline::setThreadCount(int threadCount)
+{
+    if (threadCount != getThreadCount()) {
+        mPool.reset(new WorkStealingPool(threadCount));
+    }
+}
+
+int FramePipeline::getUniverseCount()
+{
+    return mUniverseCount;
+}
+
+int FramePipeline::getThreadCount()
+{
+    return mPool->getThreadCount();
+}
+
+int *FramePipeline::getInput(int universe)
+{
+    return &mInput[universe * CHANNELS_PER_UNIVERSE];
+}
+
+const int *FramePipeline::getOutput(int universe)
+{
+    return &mOutput[universe * CHANNELS_PER_UNIVERSE];
+}
+
+void FramePipeline::process()
+{
+    mPool->run(mTasks);
+}
+
+void FramePipeline::buildTasks()
+{
+    mTasks.clear();
+    for (int universe = 0; universe < mUniverseCount; universe++) {
+        for (int start = 0; start < CHANNELS_PER_UNIVERSE; start += mBlockSize) {
+            int end = std::min(start + mBlockSize, (int) CHANNELS_PER_UNIVERSE);
+            mTasks.push_back([this, universe, start, end] {
+                processBlock(universe, start, end);
+            });
+        }
+    }
+}
+
+void FramePipeline::processBlock(int universe, int start, int end)
+{
+    const int offset = universe * CHANNELS_PER_UNIVERSE;
+    int *values = &mOutput[offset];
+    std::copy(mInput.begin() + offset + start, mInput.begin() + offset + end, values + start);
+    for (auto &stage : mStages) {
+        stage.mStage(universe, start, end, values);
+    }
+}
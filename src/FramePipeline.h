@@ -0,0 +1,59 @@
+//
+//  FramePipeline.h
+//  LightControl
+//
+
+#ifndef FramePipeline_h
+#define FramePipeline_h
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "WorkStealingPool.h"
+
+// Computes the dmx frame of every universe once per tick. A frame starts as a
+// copy of the universe input and is then passed through the stages in the
+// order they were added. Universes are split into blocks of channels and every
+// block is a separate task on the pool, so a stage only ever sees the channel
+// range [start, end) of one universe and must not touch anything else. As long
+// as stages stick to that, the output does not depend on the thread count.
+class FramePipeline {
+public:
+    static const int CHANNELS_PER_UNIVERSE = 512;
+
+    // Channels are zero based here, values are the raw dmx values.
+    typedef std::function<void(int universe, int start, int end, int *values)> Stage;
+
+    FramePipeline(int universeCount, int threadCount);
+
+    void addStage(std::string name, Stage stage);
+    void removeStage(std::string name);
+    void setBlockSize(int channels);
+    void setThreadCount(int threadCount);
+
+    int getUniverseCount();
+    int getThreadCount();
+    int *getInput(int universe);
+    const int *getOutput(int universe);
+
+    void process();
+
+private:
+    struct NamedStage {
+        std::string mName;
+        Stage mStage;
+    };
+
+    int mUniverseCount;
+    int mBlockSize;
+    std::vector<int> mInput;
+    std::vector<int> mOutput;
+    std::vector<NamedStage> mStages;
+    std::vector<std::function<void()>> mTasks;
+    std::unique_ptr<WorkStealingPool> mPool;
+
+    void buildTasks();
+    void processBlock(int universe, int start, int end);
+};
+
+#endif /* FramePipeline_h */
@@ -0,0 +1,147 @@
+//
+//  GroupMasters.cpp
+//  LightControl
+//
+
+#include "GroupMasters.h"
+#include <algorithm>
+
+GroupMasters::GroupMasters(int universeCount)
+:mUniverseCount(std::max(universeCount, 1)), mGrandMaster(1.f),
+ mSlotGroups(mUniverseCount * CHANNELS), mScales(mUniverseCount * CHANNELS, 1.f)
+{
+}
+
+void GroupMasters::clear()
+{
+    mGroups.clear();
+    for (auto &groups : mSlotGroups) {
+        groups.clear();
+    }
+    std::fill(mScales.begin(), mScales.end(), 1.f);
+}
+
+int GroupMasters::addGroup(const std::string &name, int parent, Mode mode)
+{
+    if (parent >= (int) mGroups.size()) {
+        parent = -1;
+    }
+    Group group;
+    group.mName = name;
+    group.mParent = parent;
+    group.mMode = mode;
+    group.mLevel = 1.f;
+    group.mEffective = parent >= 0 ? mGroups[parent].mEffective : 1.f;
+    int id = (int) mGroups.size();
+    mGroups.push_back(group);
+    if (parent >= 0) {
+        mGroups[parent].mChildren.push_back(id);
+    }
+    return id;
+}
+
+void GroupMasters::addChannel(int group, int universe, int channel)
+{
+    if (group < 0 || group >= (int) mGroups.size() || universe < 0 || universe >= mUniverseCount
+        || channel < 1 || channel > CHANNELS) {
+        return;
+    }
+    size_t slot = universe * CHANNELS + channel - 1;
+    auto &groups = mSlotGroups[slot];
+    if (std::find(groups.begin(), groups.end(), group) != groups.end()) {
+        return;
+    }
+    groups.push_back(group);
+    mGroups[group].mSlots.push_back(slot);
+    updateSlot(slot);
+}
+
+void GroupMasters::setLevel(int group, float level)
+{
+    if (group < 0 || group >= (int) mGroups.size()) {
+        return;
+    }
+    level = std::min(std::max(level, 0.f), 1.f);
+    if (mGroups[group].mLevel == level) {
+        return;
+    }
+    mGroups[group].mLevel = level;
+
+    // Walk the subtree once to update the effective levels, then once more for the slots,
+    // so every slot sees the final levels of all its groups.
+    mStack.clear();
+    mStack.push_back(group);
+    while (!mStack.empty()) {
+        Group &current = mGroups[mStack.back()];
+        mStack.pop_back();
+        float parentEffective = current.mParent >= 0 ? mGroups[current.mParent].mEffective : 1.f;
+        current.mEffective = getEffective(current, parentEffective);
+        mStack.insert(mStack.end(), current.mChildren.begin(), current.mChildren.end());
+    }
+    mStack.push_back(group);
+    while (!mStack.empty()) {
+        const Group &current = mGroups[mStack.back()];
+        mStack.pop_back();
+        for (size_t slot : current.mSlots) {
+            updateSlot(slot);
+        }
+        mStack.insert(mStack.end(), current.mChildren.begin(), current.mChildren.end());
+    }
+}
+
+float GroupMasters::getLevel(int group)
+{
+    if (group < 0 || group >= (int) mGroups.size()) {
+        return 0.f;
+    }
+    return mGroups[group].mLevel;
+}
+
+void GroupMasters::setGrandMaster(float level)
+{
+    mGrandMaster = level;
+}
+
+size_t GroupMasters::getGroupCount()
+{
+    return mGroups.size();
+}
+
+std::string GroupMasters::getName(int group)
+{
+    return mGroups[group].mName;
+}
+
+int GroupMasters::getParent(int group)
+{
+    return mGroups[group].mParent;
+}
+
+void GroupMasters::applyTo(int universe, int start, int end, int *values)
+{
+    if (universe >= mUniverseCount) {
+        return;
+    }
+    const float *scales = &mScales[universe * CHANNELS];
+    const float grandMaster = mGrandMaster;
+    for (int i = start; i < end; i++) {
+        values[i] = (int) (values[i] * (scales[i] * grandMaster));
+    }
+}
+
+float GroupMasters::getEffective(const Group &group, float parentEffective)
+{
+    if (group.mMode == Mode::Inhibitive) {
+        return std::min(parentEffective, group.mLevel);
+    }
+    return parentEffective * group.mLevel;
+}
+
+void GroupMasters::updateSlot(size_t slot)
+{
+    float scale = 1.f;
+    for (int group : mSlotGroups[slot]) {
+        scale = std::min(scale, mGroups[group].mEffective);
+    }
+    mScales[slot] = scale;
+}
@@ -0,0 +1,67 @@
+//
+//  GroupMasters.h
+//  LightControl
+//
+
+#ifndef GroupMasters_h
+#define GroupMasters_h
+
+#include <string>
+#include <vector>
+
+// Nested groups with their own submaster, e.g. stage left -> wash -> fixture.
+// A scaling group multiplies the level of its parent with its own, an
+// inhibitive group caps it at its own level. A channel in several groups takes
+// the lowest of their levels, channels outside any group are not scaled.
+// The hierarchy is compiled into one scale per channel. Moving a submaster
+// only recomputes the channels below that group, so applying the masters is a
+// single multiply pass over the universe.
+class GroupMasters {
+public:
+    enum class Mode { Scaling, Inhibitive };
+
+    GroupMasters(int universeCount);
+
+    void clear();
+    // Returns the id of the new group, the parent must already exist or be -1.
+    int addGroup(const std::string &name, int parent, Mode mode);
+    // One based channel, like the channels of DmxOutput.
+    void addChannel(int group, int universe, int channel);
+
+    void setLevel(int group, float level);
+    float getLevel(int group);
+    void setGrandMaster(float level);
+
+    size_t getGroupCount();
+    std::string getName(int group);
+    int getParent(int group);
+
+    // Frame pipeline stage.
+    void applyTo(int universe, int start, int end, int *values);
+
+private:
+    static const int CHANNELS = 512;
+
+    struct Group {
+        std::string mName;
+        int mParent;
+        Mode mMode;
+        float mLevel;
+        float mEffective;
+        std::vector<int> mChildren;
+        std::vector<size_t> mSlots;
+    };
+
+    int mUniverseCount;
+    float mGrandMaster;
+    std::vector<Group> mGroups;
+    // Groups directly containing each slot.
+    std::vector<std::vector<int>> mSlotGroups;
+    std::vector<float> mScales;
+    std::vector<int> mStack;
+
+    float getEffective(const Group &group, float parentEffective);
+    void updateSlot(size_t slot);
+};
+
+#endif /* GroupMasters_h */
@@ -0,0 +1,115 @@
+//
+//  IntervalIndex.cpp
+//  LightControl
+//
+
+#include "IntervalIndex.h"
+#include <algorithm>
+
+IntervalIndex::IntervalIndex()
+:mRoot(-1)
+{
+}
+
+void IntervalIndex::build(const std::vector<double> &starts, const std::vector<double> &ends)
+{
+    clear();
+    mStarts = starts;
+    mEnds = ends;
+    std::vector<size_t> items;
+    items.reserve(starts.size());
+    for (size_t i = 0; i < starts.size(); i++) {
+        // Empty intervals are never active.
+        if (ends[i] > starts[i]) {
+            items.push_back(i);
+        }
+    }
+    mRoot = buildNode(items);
+}
+
+void IntervalIndex::clear()
+{
+    mStarts.clear();
+    mEnds.clear();
+    mNodes.clear();
+    mByStart.clear();
+    mByEnd.clear();
+    mRoot = -1;
+}
+
+size_t IntervalIndex::size() const
+{
+    return mStarts.size();
+}
+
+int IntervalIndex::buildNode(std::vector<size_t> &items)
+{
+    if (items.empty()) {
+        return -1;
+    }
+    // The median start is contained by its own interval, so every node takes at
+    // least one item and both halves hold at most half of the items.
+    auto middle = items.begin() + items.size() / 2;
+    std::nth_element(items.begin(), middle, items.end(), [this](size_t a, size_t b) {
+        return mStarts[a] < mStarts[b];
+    });
+    const double center = mStarts[*middle];
+
+    std::vector<size_t> left, right, here;
+    for (size_t item : items) {
+        if (mEnds[item] <= center) {
+            left.push_back(item);
+        }
+        else if (mStarts[item] > center) {
+            right.push_back(item);
+        }
+        else {
+            here.push_back(item);
+        }
+    }
+    items.clear();
+    items.shrink_to_fit();
+
+    Node node;
+    node.mCenter = center;
+    node.mBegin = mByStart.size();
+    node.mEnd = node.mBegin + here.size();
+    std::sort(here.begin(), here.end(), [this](size_t a, size_t b) {
+        return mStarts[a] < mStarts[b];
+    });
+    mByStart.insert(mByStart.end(), here.begin(), here.end());
+    std::sort(here.begin(), here.end(), [this](size_t a, size_t b) {
+        return mEnds[a] > mEnds[b];
+    });
+    mByEnd.insert(mByEnd.end(), here.begin(), here.end());
+
+    int index = (int) mNodes.size();
+    mNodes.push_back(node);
+    int leftIndex = buildNode(left);
+    int rightIndex = buildNode(right);
+    mNodes[index].mLeft = leftIndex;
+    mNodes[index].mRight = rightIndex;
+    return index;
+}
+
+void IntervalIndex::query(double time, std::vector<size_t> &result) const
+{
+    int current = mRoot;
+    while (current >= 0) {
+        const Node &node = mNodes[current];
+        if (time < node.mCenter) {
+            // Everything here ends after the center, so only the start matters.
+            for (size_t i = node.mBegin; i < node.mEnd && mStarts[mByStart[i]] <= time; i++) {
+                result.push_back(mByStart[i]);
+            }
+            current = node.mLeft;
+        }
+        else {
+            // Everything here starts before the center, so only the end matters.
+            for (size_t i = node.mBegin; i < node.mEnd && mEnds[mByEnd[i]] > time; i++) {
+                result.push_back(mByEnd[i]);
+            }
+            current = node.mRight;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+//
+//  IntervalIndex.h
+//  LightControl
+//
+
+#ifndef IntervalIndex_h
+#define IntervalIndex_h
+
+#include <cstddef>
+#include <vector>
+
+// Static centered interval tree over half open intervals [start, end), stored
+// in flat arrays. A stabbing query walks one path from the root and only
+// scans entries that are actually active, so it costs O(log n + k) for k hits.
+// Intervals are identified by their position in the vector given to build().
+class IntervalIndex {
+public:
+    IntervalIndex();
+
+    void build(const std::vector<double> &starts, const std::vector<double> &ends);
+    void clear();
+    void query(double time, std::vector<size_t> &result) const;
+    size_t size() const;
+
+private:
+    struct Node {
+        double mCenter;
+        int mLeft;
+        int mRight;
+        // Range in mByStart and mByEnd holding the intervals that contain the center.
+        size_t mBegin;
+        size_t mEnd;
+    };
+
+    std::vector<double> mStarts;
+    std::vector<double> mEnds;
+    std::vector<Node> mNodes;
+    std::vector<size_t> mByStart;
+    std::vector<size_t> mByEnd;
+    int mRoot;
+
+    int buildNode(std::vector<size_t> &items);
+};
+
+#endif /* IntervalIndex_h */
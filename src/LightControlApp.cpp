@@ -12,6 +12,11 @@
 #include "Poco/DNSSD/DNSSDBrowser.h"
 #include "Poco/DNSSD/Bonjour/Bonjour.h"
 #include "Output.h"
+#include "FramePipeline.h"
+#include "DmxReceiver.h"
+#include "ShowTimeline.h"
+#include "TimecodeClock.h"
+#include "GroupMasters.h"
 
 using namespace ci;
 using namespace ci::app;
@@ -21,6 +26,8 @@ using protocol = asio::ip::udp;
 
 const int WINDOW_WIDTH = 1024;
 const int WINDOW_HEIGHT = 768;
+// Channels per frame pipeline task, splits a universe into eight tasks so extra worker threads get work.
+const int FRAME_BLOCK_SIZE = 64;
 
 
 bool validateIpAddress(const string &ipAddress)
@@ -30,6 +37,36 @@ bool validateIpAddress(const string &ipAddress)
     return result != 0;
 }
 
+// Reads an int, float, double or bool argument, senders don't agree on the types.
+bool getNumericArg(const osc::Message &message, uint32_t index, double &value)
+{
+    if (index >= message.getNumArgs())
+    {
+        return false;
+    }
+    switch (message.getArgType(index))
+    {
+        case osc::ArgType::INTEGER_32:
+            value = message.getArgInt32(index);
+            return true;
+        case osc::ArgType::INTEGER_64:
+            value = (double) message.getArgInt64(index);
+            return true;
+        case osc::ArgType::FLOAT:
+            value = message.getArgFloat(index);
+            return true;
+        case osc::ArgType::DOUBLE:
+            value = message.getArgDouble(index);
+            return true;
+        case osc::ArgType::BOOL_T:
+        case osc::ArgType::BOOL_F:
+            value = message.getArgBool(index) ? 1.0 : 0.0;
+            return true;
+        default:
+            return false;
+    }
+}
+
 class LightControlApp : public App
 {
   public:
@@ -68,10 +105,36 @@ class LightControlApp : public App
     // Dmx output.
     DmxOutput mDmxOut;
     bool mDmxFound;
-    int mChannelOutArray[512];
     float mVolume;
     void autoDiscoverDmx();
 
+    // Frame computation.
+    FramePipeline mFramePipeline;
+    int mFrameThreadCount;
+    void setupFramePipeline();
+
+    // Dmx input from other consoles, merged highest takes precedence with our output.
+    DmxReceiver mArtNetReceiver;
+    DmxReceiver mSacnReceiver;
+    bool mArtNetEnabled;
+    bool mSacnEnabled;
+    int mArtNetUniverse;
+    int mSacnUniverse;
+    void drawNetworkInputGui();
+
+    // Show playback against midi timecode or an osc clock.
+    ShowTimeline mTimeline;
+    TimecodeClock mTimecode;
+    std::vector<std::string> mMidiPorts;
+    std::string mShowPath;
+    bool mShowLoaded;
+    bool loadShow(const std::string &path);
+    void drawTimelineGui();
+
+    // Group submasters, mVolume acts as their grand master.
+    GroupMasters mGroupMasters;
+    void drawGroupsGui();
+
     // Zeroconf
     Poco::DNSSD::DNSSDResponder *mDnssdResponder;
     Poco::DNSSD::ServiceHandle mServiceHandle;
@@ -88,7 +151,17 @@ LightControlApp::LightControlApp()
       mOscSendAddress("192.168.1.11"),
       mVolume(0.f),
       mDmxFound(false),
-      mChannelOutArray{0},
+      mFramePipeline(1, 1),
+      mFrameThreadCount(1),
+      mArtNetReceiver(DmxReceiver::Protocol::ArtNet, 1),
+      mSacnReceiver(DmxReceiver::Protocol::Sacn, 1),
+      mArtNetEnabled(false),
+      mSacnEnabled(false),
+      mArtNetUniverse(0),
+      mSacnUniverse(1),
+      mTimeline(1),
+      mShowLoaded(false),
+      mGroupMasters(1),
       mDnssdResponder(nullptr)
 {
     Poco::DNSSD::initializeDNSSD();
@@ -117,7 +190,29 @@ void LightControlApp::setup()
 
     // Initialize params.
     setupOsc(mOscReceivePort, mOscSendPort);
-    std::fill_n(mChannelOutArray, 512, 0);
+    setupFramePipeline();
+    mMidiPorts = mTimecode.getMidiPorts();
+}
+
+void LightControlApp::setupFramePipeline()
+{
+    mFramePipeline.setThreadCount(mFrameThreadCount);
+    mFramePipeline.setBlockSize(FRAME_BLOCK_SIZE);
+    mFramePipeline.addStage("timeline", [this](int universe, int start, int end, int *values) {
+        if (mShowLoaded) {
+            mTimeline.applyTo(universe, start, end, values);
+        }
+    });
+    // Network input is merged before the masters, so the grand master also blacks out other consoles.
+    mFramePipeline.addStage("network input", [this](int universe, int start, int end, int *values) {
+        mArtNetReceiver.mergeInto(universe, start, end, values);
+        mSacnReceiver.mergeInto(universe, start, end, values);
+    });
+    mFramePipeline.addStage("master", [this](int universe, int start, int end, int *values) {
+        mGroupMasters.applyTo(universe, start, end, values);
+    });
+    mArtNetReceiver.subscribe(mArtNetUniverse, 0);
+    mSacnReceiver.subscribe(mSacnUniverse, 0);
 }
 
 void LightControlApp::setupOsc(int receivePort, int sendPort)
@@ -215,6 +310,23 @@ void LightControlApp::oscReceive(const osc::Message &message)
             if (message.getAddress() == "/volume") {
                 mVolume = message.getArgFloat(0);
                 sendVolume();
+            } else if (message.getAddress().compare(0, 7, "/group/") == 0) {
+                // Only a plain group id is accepted, "/group/" or "/group/foo" must not move group 0.
+                const char *id = message.getAddress().c_str() + 7;
+                char *idEnd = nullptr;
+                long group = std::strtol(id, &idEnd, 10);
+                double level;
+                if (idEnd != id && *idEnd == '\0' && group >= 0 && group < (long) mGroupMasters.getGroupCount()
+                    && getNumericArg(message, 0, level)) {
+                    mGroupMasters.setLevel((int) group, (float) level);
+                }
+            } else if (message.getAddress() == "/timeline/time") {
+                // Position in seconds, optionally followed by 0 when the clock is paused.
+                double position, rolling = 1.0;
+                if (getNumericArg(message, 0, position)) {
+                    getNumericArg(message, 1, rolling);
+                    mTimecode.receivePosition(position, rolling != 0.0, TimecodeClock::Clock::now());
+                }
             } else {
                 std::vector<char *> values;
                 char *str = const_cast<char *>(message.getAddress().c_str());
@@ -232,7 +344,7 @@ void LightControlApp::oscReceive(const osc::Message &message)
                     int second = std::atoi(values.at(2));
                     int third = std::atoi(values.at(3));
                     int channel = (first - 1) * 42 + (third - 1) * 6 + second;
-                    mChannelOutArray[channel - 1] = (int) message.getArgFloat(0);
+                    mFramePipeline.getInput(0)[channel - 1] = (int) message.getArgFloat(0);
                 }
             }
         }
@@ -278,10 +390,18 @@ void LightControlApp::update()
 {
     drawGui();
 
-    // Prepare DMX output.
+    // Prepare DMX output. Only the first universe is sent to the dmx interface.
+    mArtNetReceiver.update();
+    mSacnReceiver.update();
+    if (mShowLoaded) {
+        mTimeline.evaluate(mTimecode.getTime(TimecodeClock::Clock::now()));
+    }
+    mGroupMasters.setGrandMaster(mVolume);
+    mFramePipeline.process();
     mDmxOut.reset();
+    const int *frame = mFramePipeline.getOutput(0);
     for (int i = 0; i < 512; i++) {
-        mDmxOut.setChannelValue(i+1, mChannelOutArray[i] * mVolume);
+        mDmxOut.setChannelValue(i+1, frame[i]);
     }
 
     mDmxOut.update();
@@ -366,7 +486,7 @@ void LightControlApp::drawGui()
     {
         if (!mDmxOut.isConnected())
         {
-            auto devices = mDmxOut.getDevicesList();
+            const auto &devices = mDmxOut.getDevicesList();
             ui::ListBoxHeader("Choose device", devices.size());
             for (auto device : devices)
             {
@@ -390,6 +510,19 @@ void LightControlApp::drawGui()
         }
     }
     ui::Separator();
+    drawNetworkInputGui();
+    ui::Separator();
+    drawTimelineGui();
+    ui::Separator();
+    drawGroupsGui();
+    ui::Separator();
+    ui::Text("Frame pipeline");
+    if (ui::InputInt("Worker threads", &mFrameThreadCount))
+    {
+        mFrameThreadCount = math<int>::clamp(mFrameThreadCount, 1, 8);
+        mFramePipeline.setThreadCount(mFrameThreadCount);
+    }
+    ui::Separator();
     ui::Checkbox("Show DMX inspector", &showDmxInspector);
     ui::Separator();
     if (showDmxInspector)
@@ -398,6 +531,172 @@ void LightControlApp::drawGui()
     }
 }
 
+void LightControlApp::drawNetworkInputGui()
+{
+    ui::Text("Network input");
+    if (ui::Checkbox("Receive Art-Net", &mArtNetEnabled))
+    {
+        if (mArtNetEnabled && !mArtNetReceiver.start())
+        {
+            CI_LOG_E("Could not bind the Art-Net port " << DmxReceiver::ARTNET_PORT);
+            mArtNetEnabled = false;
+        }
+        if (!mArtNetEnabled)
+        {
+            mArtNetReceiver.stop();
+        }
+    }
+    int universe = mArtNetUniverse;
+    if (ui::InputInt("Art-Net universe", &universe) && universe >= 0 && universe < 32768)
+    {
+        mArtNetReceiver.unsubscribe(mArtNetUniverse);
+        mArtNetUniverse = universe;
+        mArtNetReceiver.subscribe(mArtNetUniverse, 0);
+    }
+    if (ui::Checkbox("Receive sACN", &mSacnEnabled))
+    {
+        if (mSacnEnabled && !mSacnReceiver.start())
+        {
+            CI_LOG_E("Could not bind the sACN port " << DmxReceiver::SACN_PORT);
+            mSacnEnabled = false;
+        }
+        if (!mSacnEnabled)
+        {
+            mSacnReceiver.stop();
+        }
+    }
+    universe = mSacnUniverse;
+    if (ui::InputInt("sACN universe", &universe) && universe >= 1 && universe < 64000)
+    {
+        mSacnReceiver.unsubscribe(mSacnUniverse);
+        mSacnUniverse = universe;
+        mSacnReceiver.subscribe(mSacnUniverse, 0);
+    }
+    for (auto &source : mArtNetReceiver.getSources())
+    {
+        ui::Text("Art-Net: %s (universe %d)", source.mName.c_str(), source.mUniverse);
+    }
+    for (auto &source : mSacnReceiver.getSources())
+    {
+        ui::Text("sACN: %s (universe %d, priority %d)", source.mName.c_str(), source.mUniverse, source.mPriority);
+    }
+}
+
+bool LightControlApp::loadShow(const std::string &path)
+{
+    mTimeline.clear();
+    mGroupMasters.clear();
+    mShowLoaded = false;
+    try
+    {
+        JsonTree show(loadFile(path));
+        if (show.hasChild("groups"))
+        {
+            // Parents refer to the position of an earlier group in the list.
+            for (auto &item : show["groups"])
+            {
+                int parent = item.hasChild("parent") ? item.getValueForKey<int>("parent") : -1;
+                bool inhibitive = item.hasChild("mode") && item.getValueForKey("mode") == "inhibitive";
+                int group = mGroupMasters.addGroup(item.getValueForKey("name"), parent,
+                                                   inhibitive ? GroupMasters::Mode::Inhibitive : GroupMasters::Mode::Scaling);
+                int universe = item.hasChild("universe") ? item.getValueForKey<int>("universe") : 0;
+                if (item.hasChild("channels"))
+                {
+                    for (auto &channel : item["channels"])
+                    {
+                        mGroupMasters.addChannel(group, universe, channel.getValue<int>());
+                    }
+                }
+            }
+        }
+        if (show.hasChild("events"))
+        {
+            for (auto &item : show["events"])
+            {
+                TimelineEvent event;
+                const std::string type = item.hasChild("type") ? item.getValueForKey("type") : "fader";
+                event.mType = type == "fade" ? TimelineEvent::Fade : type == "effect" ? TimelineEvent::Effect : TimelineEvent::Fader;
+                event.mStart = item.getValueForKey<double>("start");
+                event.mEnd = item.getValueForKey<double>("end");
+                event.mUniverse = item.hasChild("universe") ? item.getValueForKey<int>("universe") : 0;
+                event.mChannel = item.getValueForKey<int>("channel");
+                event.mValue = item.getValueForKey<float>("value");
+                event.mEndValue = item.hasChild("endValue") ? item.getValueForKey<float>("endValue") : 0.f;
+                event.mPeriod = item.hasChild("period") ? item.getValueForKey<double>("period") : 1.0;
+                event.mCue = item.hasChild("cue") ? item.getValueForKey<int>("cue") : 0;
+                mTimeline.addEvent(event);
+            }
+        }
+    }
+    catch (std::exception &exc)
+    {
+        CI_LOG_E("Error loading show " << path << ": " << exc.what());
+        mTimeline.clear();
+        mGroupMasters.clear();
+        return false;
+    }
+    mTimeline.build();
+    mShowLoaded = true;
+    return true;
+}
+
+void LightControlApp::drawTimelineGui()
+{
+    ui::Text("Timeline");
+    ui::InputText("Show file", &mShowPath);
+    ui::SameLine();
+    if (ui::Button("Load"))
+    {
+        loadShow(mShowPath);
+    }
+    if (!mTimecode.isMidiPortOpen())
+    {
+        ui::ListBoxHeader("Midi timecode port", mMidiPorts.size());
+        for (unsigned int i = 0; i < mMidiPorts.size(); i++)
+        {
+            if (ui::Selectable(mMidiPorts[i].c_str()))
+            {
+                mTimecode.openMidiPort(i);
+            }
+        }
+        ui::ListBoxFooter();
+        if (ui::Button("Refresh midi ports"))
+        {
+            mMidiPorts = mTimecode.getMidiPorts();
+        }
+    }
+    else if (ui::Button("Close midi timecode port"))
+    {
+        mTimecode.closeMidiPort();
+    }
+    auto now = TimecodeClock::Clock::now();
+    ui::Text("Time: %.3f %s", mTimecode.getTime(now), mTimecode.isRolling(now) ? "(rolling)" : "(stopped)");
+    if (mShowLoaded)
+    {
+        ui::Text("Events: %zu, active: %zu, cue: %d", mTimeline.getEventCount(), mTimeline.getActiveEventCount(), mTimeline.getActiveCue());
+    }
+}
+
+void LightControlApp::drawGroupsGui()
+{
+    ui::Text("Groups: %zu", mGroupMasters.getGroupCount());
+    // Only the top level submasters, nested ones are moved over osc with /group/<id>.
+    for (int group = 0; group < (int) mGroupMasters.getGroupCount(); group++)
+    {
+        if (mGroupMasters.getParent(group) >= 0)
+        {
+            continue;
+        }
+        float level = mGroupMasters.getLevel(group);
+        ui::PushID(group);
+        if (ui::SliderFloat(mGroupMasters.getName(group).c_str(), &level, 0.f, 1.f))
+        {
+            mGroupMasters.setLevel(group, level);
+        }
+        ui::PopID();
+    }
+}
+
 void LightControlApp::drawDmxInspector()
 {
     ImGui::ScopedWindow window("Dmx inspector");
@@ -412,8 +711,8 @@ void LightControlApp::autoDiscoverDmx() {
     if (mDmxFound || mDmxOut.isConnected()) {
         return;
     }
-    if (mDmxOut.getDevicesList().size() == 1 && ! mDmxOut.isConnected()) {
-        auto devices = mDmxOut.getDevicesList();
+    const auto &devices = mDmxOut.getDevicesList();
+    if (devices.size() == 1) {
         mDmxOut.connect(devices[0]);
         mDmxFound = true;
     }
@@ -422,6 +721,8 @@ void LightControlApp::autoDiscoverDmx() {
 LightControlApp::~LightControlApp()
 {
     mDmxOut.disConnect();
+    mArtNetReceiver.stop();
+    mSacnReceiver.stop();
     mDnssdResponder->unregisterService(mServiceHandle);
     mDnssdResponder->browser().cancel(mBrowserHandle);
     mDnssdResponder->stop();
@@ -10,8 +10,10 @@
 #include "DMXPro.h"
 
 DmxOutput::DmxOutput()
-:mOut{0}, mWidth(320), mHeight(320), mDmxPro(nullptr), mDmxProIsConnected(false)
+:mOut{0}, mWidth(320), mHeight(320), mDmxPro(nullptr), mDmxProIsConnected(false),
+ mDeviceMonitor(&DmxOutput::enumerateDmxDevices), mDevicesRevision(0)
 {
+    mDeviceMonitor.start();
     gl::Fbo::Format format;
     format.colorTexture();
     mFbo = gl::Fbo::create(mWidth, mHeight, format);
@@ -54,6 +56,7 @@ void DmxOutput::reset()
 
 void DmxOutput::update()
 {
+    handleDeviceEvents();
     if (mDmxPro != nullptr && mDmxPro->isConnected()) {
         for (int i = 0; i < 512; i++) {
             mDmxPro->setValue(mOut[i], i);
@@ -61,11 +64,22 @@ void DmxOutput::update()
     }
 }
 
-std::vector<std::string> DmxOutput::getDevicesList() {
+const std::vector<std::string> &DmxOutput::getDevicesList() {
+    if (mDevicesRevision != mDeviceMonitor.getRevision()) {
+        mDevicesRevision = mDeviceMonitor.getRevision();
+        mDevices = mDeviceMonitor.getDevices();
+    }
+    return mDevices;
+}
+
+std::vector<std::string> DmxOutput::enumerateDmxDevices() {
     std::vector<std::string> devices = DMXPro::getDevicesList();
     std::vector<std::string> dmxDevices;
     for (auto deviceName : devices) {
-        if (deviceName.find("tty.usbserial") != std::string::npos) {
+        // tty.usbserial on macOS, ttyUSB or a /dev/serial/by-id link on Linux.
+        if (deviceName.find("tty.usbserial") != std::string::npos
+            || deviceName.find("ttyUSB") != std::string::npos
+            || deviceName.find("serial/by-id") != std::string::npos) {
             dmxDevices.push_back(deviceName);
         }
     }
@@ -76,15 +90,43 @@ void DmxOutput::connect(std::string deviceName)
 {
     if (!mDmxProIsConnected) {
         console() << "Starting connection" << std::endl;
+        std::lock_guard<std::mutex> lock(mDeviceMonitor.getEnumerationMutex());
         mDmxPro = DMXPro::create(deviceName);
         mDmxProIsConnected = true;
+        mConfiguredDevice = deviceName;
     }
 }
 
 void DmxOutput::disConnect()
 {
+    std::lock_guard<std::mutex> lock(mDeviceMonitor.getEnumerationMutex());
     mDmxPro = nullptr;
     mDmxProIsConnected = false;
+    mConfiguredDevice = "";
+}
+
+void DmxOutput::handleDeviceEvents()
+{
+    if (mConfiguredDevice.empty()) {
+        mDeviceMonitor.pollEvents();
+        return;
+    }
+    for (auto &event : mDeviceMonitor.pollEvents()) {
+        if (event.mDevice != mConfiguredDevice) {
+            continue;
+        }
+        if (event.mType == DeviceMonitor::Event::Removed && mDmxProIsConnected) {
+            console() << "Dmx device " << event.mDevice << " removed, waiting for it to come back" << std::endl;
+            // Drop the connection but remember the device, so it reconnects when it is plugged in again.
+            std::lock_guard<std::mutex> lock(mDeviceMonitor.getEnumerationMutex());
+            mDmxPro = nullptr;
+            mDmxProIsConnected = false;
+        }
+        else if (event.mType == DeviceMonitor::Event::Arrived && !mDmxProIsConnected) {
+            console() << "Dmx device " << event.mDevice << " is back, reconnecting" << std::endl;
+            connect(event.mDevice);
+        }
+    }
 }
 
 bool DmxOutput::isConnected()
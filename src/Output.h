@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include "DMXPro.h"
 #include "cinder/Text.h"
+#include "DeviceMonitor.h"
 
 using namespace cinder;
 using namespace cinder::app;
@@ -24,7 +25,8 @@ public:
     void reset();
     void update();
     
-    std::vector<std::string> getDevicesList();
+    // Cached by the device monitor, cheap enough to call every frame.
+    const std::vector<std::string> &getDevicesList();
     void connect(std::string deviceName);
     void disConnect();
     bool isConnected();
@@ -48,6 +50,15 @@ private:
     
     DMXProRef mDmxPro;
     bool mDmxProIsConnected;
+    // The device to reconnect to when it reappears, empty after a manual disconnect.
+    std::string mConfiguredDevice;
+
+    DeviceMonitor mDeviceMonitor;
+    std::vector<std::string> mDevices;
+    uint64_t mDevicesRevision;
+
+    static std::vector<std::string> enumerateDmxDevices();
+    void handleDeviceEvents();
 
     gl::Texture2dRef mValueTextures[256];
 
@@ -0,0 +1,138 @@
+//
+//  ShowTimeline.cpp
+//  LightControl
+//
+
+#include "ShowTimeline.h"
+#include <algorithm>
+#include <cmath>
+
+ShowTimeline::ShowTimeline(int universeCount)
+:mUniverseCount(std::max(universeCount, 1)), mDuration(0.0),
+ mWinners(mUniverseCount * CHANNELS, -1), mValues(mUniverseCount * CHANNELS, 0), mActiveCue(0)
+{
+}
+
+void ShowTimeline::clear()
+{
+    mEvents.clear();
+    mIndex.clear();
+    mDuration = 0.0;
+    mActive.clear();
+    for (size_t slot : mTouched) {
+        mWinners[slot] = -1;
+    }
+    mTouched.clear();
+    mActiveCue = 0;
+}
+
+void ShowTimeline::addEvent(const TimelineEvent &event)
+{
+    if (event.mUniverse < 0 || event.mUniverse >= mUniverseCount || event.mChannel < 1 || event.mChannel > CHANNELS) {
+        return;
+    }
+    mEvents.push_back(event);
+}
+
+void ShowTimeline::build()
+{
+    std::vector<double> starts, ends;
+    starts.reserve(mEvents.size());
+    ends.reserve(mEvents.size());
+    mDuration = 0.0;
+    for (auto &event : mEvents) {
+        starts.push_back(event.mStart);
+        ends.push_back(event.mEnd);
+        mDuration = std::max(mDuration, event.mEnd);
+    }
+    mIndex.build(starts, ends);
+}
+
+void ShowTimeline::evaluate(double time)
+{
+    for (size_t slot : mTouched) {
+        mWinners[slot] = -1;
+    }
+    mTouched.clear();
+    mActive.clear();
+    mIndex.query(time, mActive);
+
+    mActiveCue = 0;
+    double cueStart = 0.0;
+    for (size_t index : mActive) {
+        const TimelineEvent &event = mEvents[index];
+        size_t slot = event.mUniverse * CHANNELS + event.mChannel - 1;
+        long winner = mWinners[slot];
+        if (winner < 0) {
+            mTouched.push_back(slot);
+        }
+        // Latest start takes precedence, on a tie the event added last wins.
+        if (winner < 0 || event.mStart > mEvents[winner].mStart
+            || (event.mStart == mEvents[winner].mStart && (long) index > winner)) {
+            mWinners[slot] = index;
+        }
+        if (event.mCue != 0 && (mActiveCue == 0 || event.mStart > cueStart)) {
+            mActiveCue = event.mCue;
+            cueStart = event.mStart;
+        }
+    }
+    for (size_t slot : mTouched) {
+        float value = getValue(mEvents[mWinners[slot]], time);
+        mValues[slot] = std::min(std::max((int) std::lround(value), 0), 255);
+    }
+}
+
+void ShowTimeline::applyTo(int universe, int start, int end, int *values)
+{
+    if (universe >= mUniverseCount) {
+        return;
+    }
+    const size_t offset = universe * CHANNELS;
+    for (int i = start; i < end; i++) {
+        if (mWinners[offset + i] >= 0) {
+            values[i] = mValues[offset + i];
+        }
+    }
+}
+
+size_t ShowTimeline::getEventCount()
+{
+    return mEvents.size();
+}
+
+size_t ShowTimeline::getActiveEventCount()
+{
+    return mActive.size();
+}
+
+int ShowTimeline::getActiveCue()
+{
+    return mActiveCue;
+}
+
+double ShowTimeline::getDuration()
+{
+    return mDuration;
+}
+
+float ShowTimeline::getValue(const TimelineEvent &event, double time)
+{
+    switch (event.mType) {
+        case TimelineEvent::Fade: {
+            double progress = (time - event.mStart) / (event.mEnd - event.mStart);
+            return (float) (event.mValue + (event.mEndValue - event.mValue) * progress);
+        }
+        case TimelineEvent::Effect: {
+            if (event.mPeriod <= 0.0) {
+                return event.mValue;
+            }
+            // Phase is bound to the start of the event, so a seek lands on the same value as playback.
+            double phase = std::fmod(time - event.mStart, event.mPeriod) / event.mPeriod;
+            double amount = 0.5 - 0.5 * std::cos(phase * 2.0 * M_PI);
+            return (float) (event.mValue + (event.mEndValue - event.mValue) * amount);
+        }
+        case TimelineEvent::Fader:
+        default:
+            return event.mValue;
+    }
+}
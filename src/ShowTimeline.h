@@ -0,0 +1,76 @@
+//
+//  ShowTimeline.h
+//  LightControl
+//
+
+#ifndef ShowTimeline_h
+#define ShowTimeline_h
+
+#include <vector>
+#include "IntervalIndex.h"
+
+struct TimelineEvent {
+    enum Type {
+        // Holds mValue.
+        Fader,
+        // Fades linearly from mValue to mEndValue over the event.
+        Fade,
+        // Sine between mValue and mEndValue with mPeriod seconds, starting at mValue.
+        Effect
+    };
+
+    Type mType;
+    double mStart;
+    double mEnd;
+    int mUniverse;
+    // One based, like the channels of DmxOutput.
+    int mChannel;
+    float mValue;
+    float mEndValue;
+    double mPeriod;
+    // Cue the event belongs to, 0 for none.
+    int mCue;
+};
+
+// Show timeline for playback against timecode. The output at a given time is
+// derived from the events active at that time only: per channel the event that
+// started last wins. This makes playing, seeking and scrubbing the same
+// operation, a stabbing query on the interval index, and nothing has to be
+// replayed from the start of the show.
+class ShowTimeline {
+public:
+    ShowTimeline(int universeCount);
+
+    void clear();
+    void addEvent(const TimelineEvent &event);
+    // Must be called after adding events and before evaluating.
+    void build();
+
+    void evaluate(double time);
+    // Frame pipeline stage, overrides the channels the timeline controls.
+    void applyTo(int universe, int start, int end, int *values);
+
+    size_t getEventCount();
+    size_t getActiveEventCount();
+    int getActiveCue();
+    double getDuration();
+
+private:
+    static const int CHANNELS = 512;
+
+    int mUniverseCount;
+    std::vector<TimelineEvent> mEvents;
+    IntervalIndex mIndex;
+    double mDuration;
+
+    std::vector<size_t> mActive;
+    std::vector<size_t> mTouched;
+    // Per slot: index of the winning event or -1, and its current value.
+    std::vector<long> mWinners;
+    std::vector<int> mValues;
+    int mActiveCue;
+
+    float getValue(const TimelineEvent &event, double time);
+};
+
+#endif /* ShowTimeline_h */
@@ -0,0 +1,189 @@
+//
+//  TimecodeClock.cpp
+//  LightControl
+//
+
+#include "TimecodeClock.h"
+#include <algorithm>
+#include "RtMidi.h"
+
+namespace {
+    const double MIDI_TIMEOUT = 0.1;
+    const double EXTERNAL_TIMEOUT = 0.5;
+
+    void midiCallback(double deltaTime, std::vector<unsigned char> *message, void *userData)
+    {
+        if (message && !message->empty()) {
+            static_cast<TimecodeClock *>(userData)->receiveMidi(message->data(), message->size(),
+                                                                TimecodeClock::Clock::now());
+        }
+    }
+}
+
+TimecodeClock::TimecodeClock()
+:mPosition(0.0), mRolling(false), mTimeout(MIDI_TIMEOUT), mMaxExtrapolation(0.0), mFrameRate(25.0),
+ mPieces{0}, mReceivedPieces(0), mQuarterFramesSynced(false)
+{
+}
+
+TimecodeClock::~TimecodeClock()
+{
+    closeMidiPort();
+}
+
+std::vector<std::string> TimecodeClock::getMidiPorts()
+{
+    std::vector<std::string> ports;
+    try {
+        RtMidiIn midiIn;
+        for (unsigned int i = 0; i < midiIn.getPortCount(); i++) {
+            ports.push_back(midiIn.getPortName(i));
+        }
+    }
+    catch (RtMidiError &error) {
+        // No midi available, so no ports.
+    }
+    return ports;
+}
+
+bool TimecodeClock::openMidiPort(unsigned int port)
+{
+    closeMidiPort();
+    try {
+        mMidiIn.reset(new RtMidiIn());
+        mMidiIn->openPort(port);
+        // Sysex carries the full frame messages, time the quarter frames.
+        mMidiIn->ignoreTypes(false, false, true);
+        mMidiIn->setCallback(&midiCallback, this);
+    }
+    catch (RtMidiError &error) {
+        mMidiIn = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void TimecodeClock::closeMidiPort()
+{
+    if (mMidiIn) {
+        mMidiIn->cancelCallback();
+        mMidiIn->closePort();
+        mMidiIn = nullptr;
+    }
+}
+
+bool TimecodeClock::isMidiPortOpen()
+{
+    return mMidiIn != nullptr;
+}
+
+void TimecodeClock::receiveMidi(const unsigned char *message, size_t size, Clock::time_point when)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (size == 2 && message[0] == 0xf1) {
+        receiveQuarterFrame(message[1], when);
+    }
+    else if (size == 10 && message[0] == 0xf0 && message[1] == 0x7f && message[3] == 0x01 && message[4] == 0x01) {
+        receiveFullFrame(message, when);
+    }
+}
+
+void TimecodeClock::receivePosition(double seconds, bool rolling, Clock::time_point when)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPosition = seconds;
+    mPositionTime = when;
+    mRolling = rolling;
+    mTimeout = EXTERNAL_TIMEOUT;
+    mMaxExtrapolation = EXTERNAL_TIMEOUT;
+    mQuarterFramesSynced = false;
+}
+
+double TimecodeClock::getTime(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mRolling) {
+        return mPosition;
+    }
+    double elapsed = std::chrono::duration<double>(now - mPositionTime).count();
+    return mPosition + std::min(std::max(elapsed, 0.0), mMaxExtrapolation);
+}
+
+bool TimecodeClock::isRolling(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRolling && std::chrono::duration<double>(now - mPositionTime).count() <= mTimeout;
+}
+
+double TimecodeClock::getFrameRate()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFrameRate;
+}
+
+void TimecodeClock::receiveQuarterFrame(int data, Clock::time_point when)
+{
+    int piece = (data >> 4) & 0x07;
+    mPieces[piece] = data & 0x0f;
+    mReceivedPieces |= 1 << piece;
+    const double quarterFrame = 1.0 / (mFrameRate * 4.0);
+
+    if (mQuarterFramesSynced) {
+        mPosition += quarterFrame;
+    }
+    if (piece == 7 && mReceivedPieces == 0xff) {
+        int rateBits = (mPieces[7] >> 1) & 0x03;
+        int hours = ((mPieces[7] & 0x01) << 4) | mPieces[6];
+        int minutes = (mPieces[5] << 4) | mPieces[4];
+        int seconds = (mPieces[3] << 4) | mPieces[2];
+        int frames = (mPieces[1] << 4) | mPieces[0];
+        mFrameRate = getRate(rateBits);
+        // The timecode is the frame at which piece 0 was sent, piece 7 arrives seven quarter frames later.
+        mPosition = toSeconds(hours, minutes, seconds, frames, rateBits) + 7.0 / (mFrameRate * 4.0);
+        mQuarterFramesSynced = true;
+        mReceivedPieces = 0;
+    }
+    if (mQuarterFramesSynced) {
+        mPositionTime = when;
+        mRolling = true;
+        mTimeout = MIDI_TIMEOUT;
+        mMaxExtrapolation = 1.0 / (mFrameRate * 4.0);
+    }
+}
+
+void TimecodeClock::receiveFullFrame(const unsigned char *message, Clock::time_point when)
+{
+    // F0 7F <device> 01 01 hh mm ss ff F7, sent when the transport locates.
+    int rateBits = (message[5] >> 5) & 0x03;
+    mFrameRate = getRate(rateBits);
+    mPosition = toSeconds(message[5] & 0x1f, message[6], message[7], message[8], rateBits);
+    mPositionTime = when;
+    mRolling = false;
+    mQuarterFramesSynced = false;
+    mReceivedPieces = 0;
+}
+
+double TimecodeClock::toSeconds(int hours, int minutes, int seconds, int frames, int rateBits)
+{
+    if (rateBits == 2) {
+        // Drop frame: frame numbers 0 and 1 are skipped every minute, except every tenth minute.
+        int totalMinutes = hours * 60 + minutes;
+        long frameNumber = 30L * (hours * 3600 + minutes * 60 + seconds) + frames - 2 * (totalMinutes - totalMinutes / 10);
+        return frameNumber / getRate(rateBits);
+    }
+    return hours * 3600 + minutes * 60 + seconds + frames / getRate(rateBits);
+}
+
+double TimecodeClock::getRate(int rateBits)
+{
+    switch (rateBits) {
+        case 0:
+            return 24.0;
+        case 1:
+            return 25.0;
+        case 2:
+            return 30000.0 / 1001.0;
+        default:
+            return 30.0;
+    }
+}
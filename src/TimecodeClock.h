@@ -0,0 +1,68 @@
+//
+//  TimecodeClock.h
+//  LightControl
+//
+
+#ifndef TimecodeClock_h
+#define TimecodeClock_h
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class RtMidiIn;
+
+// Show clock that follows MIDI timecode or an external OSC/UDP clock. Between
+// updates the position is extrapolated with the wall clock, which gives sub
+// frame positions. When updates stop arriving the clock holds its last
+// position. All feeds take the time of arrival as an argument, so a simulated
+// source can drive the clock without a midi port or network.
+class TimecodeClock {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    TimecodeClock();
+    ~TimecodeClock();
+
+    std::vector<std::string> getMidiPorts();
+    bool openMidiPort(unsigned int port);
+    void closeMidiPort();
+    bool isMidiPortOpen();
+
+    // Quarter frame (0xF1) and full frame sysex timecode messages, everything else is ignored.
+    void receiveMidi(const unsigned char *message, size_t size, Clock::time_point when);
+    // Position of an external clock, rolling or paused.
+    void receivePosition(double seconds, bool rolling, Clock::time_point when);
+
+    double getTime(Clock::time_point now);
+    bool isRolling(Clock::time_point now);
+    double getFrameRate();
+
+private:
+    std::mutex mMutex;
+    std::unique_ptr<RtMidiIn> mMidiIn;
+
+    // Last known position and when it was valid.
+    double mPosition;
+    Clock::time_point mPositionTime;
+    bool mRolling;
+    // Updates are expected at least this often while rolling.
+    double mTimeout;
+    // How far the position may run ahead of the last update.
+    double mMaxExtrapolation;
+    double mFrameRate;
+
+    // Quarter frame assembly.
+    int mPieces[8];
+    int mReceivedPieces;
+    bool mQuarterFramesSynced;
+
+    void receiveQuarterFrame(int data, Clock::time_point when);
+    void receiveFullFrame(const unsigned char *message, Clock::time_point when);
+    static double toSeconds(int hours, int minutes, int seconds, int frames, int rateBits);
+    static double getRate(int rateBits);
+};
+
+#endif /* TimecodeClock_h */
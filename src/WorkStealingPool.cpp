@@ -0,0 +1,121 @@
+//
+//  WorkStealingPool.cpp
+//  LightControl
+//
+
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+:mTasks(nullptr), mGeneration(0), mRemaining(0), mStopping(false)
+{
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        mQueues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+    }
+    for (int i = 1; i < threadCount; i++) {
+        mThreads.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWorkAvailable.notify_all();
+    for (auto &thread : mThreads) {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::getThreadCount()
+{
+    return (int) mQueues.size();
+}
+
+void WorkStealingPool::run(const std::vector<std::function<void()>> &tasks)
+{
+    if (tasks.empty()) {
+        return;
+    }
+    if (mThreads.empty()) {
+        for (auto &task : tasks) {
+            task();
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks = &tasks;
+        mRemaining = tasks.size();
+        // Hand out the tasks round robin, so neighbouring universes start on different workers.
+        for (size_t i = 0; i < tasks.size(); i++) {
+            TaskQueue &queue = *mQueues[i % mQueues.size()];
+            std::lock_guard<std::mutex> queueLock(queue.mMutex);
+            queue.mTasks.push_back(i);
+        }
+        mGeneration++;
+    }
+    mWorkAvailable.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWorkDone.wait(lock, [this] { return mRemaining == 0; });
+    mTasks = nullptr;
+}
+
+void WorkStealingPool::workerLoop(int index)
+{
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkAvailable.wait(lock, [&] { return mStopping || mGeneration != seenGeneration; });
+            if (mStopping) {
+                return;
+            }
+            seenGeneration = mGeneration;
+        }
+        drain(index);
+    }
+}
+
+void WorkStealingPool::drain(int index)
+{
+    size_t task;
+    while (popTask(index, task)) {
+        (*mTasks)[task]();
+        if (--mRemaining == 0) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mWorkDone.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::popTask(int index, size_t &task)
+{
+    // Own work is taken from the front, stolen work from the back of another queue.
+    {
+        TaskQueue &own = *mQueues[index];
+        std::lock_guard<std::mutex> lock(own.mMutex);
+        if (!own.mTasks.empty()) {
+            task = own.mTasks.front();
+            own.mTasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < mQueues.size(); offset++) {
+        TaskQueue &victim = *mQueues[(index + offset) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(victim.mMutex);
+        if (!victim.mTasks.empty()) {
+            task = victim.mTasks.back();
+            victim.mTasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
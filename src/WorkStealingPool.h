@@ -0,0 +1,54 @@
+//
+//  WorkStealingPool.h
+//  LightControl
+//
+
+#ifndef WorkStealingPool_h
+#define WorkStealingPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed size pool that runs one batch of tasks at a time. Every worker
+// owns a queue and steals from the others once its own queue is empty. The
+// calling thread takes part as worker 0, so a pool of one thread spawns nothing.
+// run() only returns when every task of the batch has finished, which makes it
+// the per tick barrier of the frame pipeline.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threadCount);
+    ~WorkStealingPool();
+
+    void run(const std::vector<std::function<void()>> &tasks);
+    int getThreadCount();
+
+private:
+    struct TaskQueue {
+        std::mutex mMutex;
+        std::deque<size_t> mTasks;
+    };
+
+    void workerLoop(int index);
+    void drain(int index);
+    bool popTask(int index, size_t &task);
+
+    std::vector<std::unique_ptr<TaskQueue>> mQueues;
+    std::vector<std::thread> mThreads;
+    const std::vector<std::function<void()>> *mTasks;
+
+    std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mWorkDone;
+    uint64_t mGeneration;
+    std::atomic<size_t> mRemaining;
+    bool mStopping;
+};
+
+#endif /* WorkStealingPool_h */
@@ -0,0 +1,47 @@
+//
+//  Check.h
+//  LightControl
+//
+
+#ifndef Check_h
+#define Check_h
+
+#include <iostream>
+
+// Minimal checks for the standalone tests, a test returns check::result() from main.
+namespace check {
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result()
+    {
+        if (failures() > 0) {
+            std::cerr << failures() << " check(s) failed" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            check::failures()++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance) \
+    do { \
+        double checkValue = (value), checkExpected = (expected); \
+        if (checkValue < checkExpected - (tolerance) || checkValue > checkExpected + (tolerance)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #value " = " << checkValue \
+                      << ", expected " << checkExpected << std::endl; \
+            check::failures()++; \
+        } \
+    } while (0)
+
+#endif /* Check_h */
@@ -0,0 +1,185 @@
+//
+//  DeviceMonitorTest.cpp
+//  LightControl
+//
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.h"
+#include "DeviceMonitor.h"
+
+namespace {
+    // Stands in for the serial port enumeration, the tests change the list and request a rescan.
+    class FakeEnumerator {
+    public:
+        FakeEnumerator() :mScans(0) {}
+
+        void setDevices(const std::vector<std::string> &devices)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDevices = devices;
+        }
+
+        std::vector<std::string> enumerate()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mScans++;
+            return mDevices;
+        }
+
+        int getScans()
+        {
+            return mScans;
+        }
+
+    private:
+        std::mutex mMutex;
+        std::vector<std::string> mDevices;
+        std::atomic<int> mScans;
+    };
+
+    // Requests a rescan and waits until the monitor thread has enumerated again.
+    bool rescan(DeviceMonitor &monitor, FakeEnumerator &enumerator)
+    {
+        int scans = enumerator.getScans();
+        monitor.requestRescan();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (enumerator.getScans() == scans && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        // The list is swapped in right after the enumerator returns.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return enumerator.getScans() > scans;
+    }
+
+    void testArrivalsAndRemovals()
+    {
+        FakeEnumerator enumerator;
+        enumerator.setDevices({"/dev/ttyUSB1", "/dev/ttyUSB0"});
+        DeviceMonitor monitor([&enumerator]() { return enumerator.enumerate(); });
+        monitor.start();
+        CHECK(rescan(monitor, enumerator));
+
+        // The first scan reports everything that is already there, sorted.
+        std::vector<std::string> expected = {"/dev/ttyUSB0", "/dev/ttyUSB1"};
+        CHECK(monitor.getDevices() == expected);
+        auto events = monitor.pollEvents();
+        CHECK(events.size() == 2);
+        CHECK(events[0].mType == DeviceMonitor::Event::Arrived && events[0].mDevice == "/dev/ttyUSB0");
+        CHECK(events[1].mType == DeviceMonitor::Event::Arrived && events[1].mDevice == "/dev/ttyUSB1");
+        // Polling drains the queue.
+        CHECK(monitor.pollEvents().empty());
+
+        enumerator.setDevices({"/dev/ttyUSB1", "/dev/ttyUSB2"});
+        CHECK(rescan(monitor, enumerator));
+        events = monitor.pollEvents();
+        CHECK(events.size() == 2);
+        CHECK(events[0].mType == DeviceMonitor::Event::Arrived && events[0].mDevice == "/dev/ttyUSB2");
+        CHECK(events[1].mType == DeviceMonitor::Event::Removed && events[1].mDevice == "/dev/ttyUSB0");
+        CHECK(monitor.pollEvents().empty());
+
+        enumerator.setDevices({});
+        CHECK(rescan(monitor, enumerator));
+        events = monitor.pollEvents();
+        CHECK(events.size() == 2);
+        CHECK(events[0].mType == DeviceMonitor::Event::Removed && events[1].mType == DeviceMonitor::Event::Removed);
+        CHECK(monitor.getDevices().empty());
+        monitor.stop();
+    }
+
+    void testRevisionOnlyChangesWithTheList()
+    {
+        FakeEnumerator enumerator;
+        DeviceMonitor monitor([&enumerator]() { return enumerator.enumerate(); });
+        monitor.start();
+        CHECK(rescan(monitor, enumerator));
+        uint64_t revision = monitor.getRevision();
+        CHECK(revision == 0);
+
+        enumerator.setDevices({"/dev/ttyUSB0"});
+        CHECK(rescan(monitor, enumerator));
+        CHECK(monitor.getRevision() == revision + 1);
+
+        // Scanning the same list again, even in another order, changes nothing.
+        CHECK(rescan(monitor, enumerator));
+        CHECK(monitor.getRevision() == revision + 1);
+        enumerator.setDevices({"/dev/ttyUSB1", "/dev/ttyUSB0"});
+        CHECK(rescan(monitor, enumerator));
+        CHECK(monitor.getRevision() == revision + 2);
+        enumerator.setDevices({"/dev/ttyUSB0", "/dev/ttyUSB1"});
+        CHECK(rescan(monitor, enumerator));
+        CHECK(monitor.getRevision() == revision + 2);
+        CHECK(monitor.pollEvents().size() == 2);
+        monitor.stop();
+    }
+
+    void testReplugBetweenScans()
+    {
+        FakeEnumerator enumerator;
+        enumerator.setDevices({"/dev/serial/by-id/usb-ENTTEC_DMX_USB_PRO-if00", "/dev/ttyUSB1"});
+        DeviceMonitor monitor([&enumerator]() { return enumerator.enumerate(); });
+        monitor.start();
+        CHECK(rescan(monitor, enumerator));
+        CHECK(monitor.pollEvents().size() == 2);
+        uint64_t revision = monitor.getRevision();
+
+        // The node went away and came back before the scan, the list itself is the same.
+        monitor.notifyRemoved("usb-ENTTEC_DMX_USB_PRO-if00");
+        CHECK(rescan(monitor, enumerator));
+        auto events = monitor.pollEvents();
+        CHECK(events.size() == 2);
+        CHECK(events[0].mType == DeviceMonitor::Event::Removed);
+        CHECK(events[0].mDevice == "/dev/serial/by-id/usb-ENTTEC_DMX_USB_PRO-if00");
+        CHECK(events[1].mType == DeviceMonitor::Event::Arrived);
+        CHECK(events[1].mDevice == "/dev/serial/by-id/usb-ENTTEC_DMX_USB_PRO-if00");
+        CHECK(monitor.getRevision() == revision);
+
+        // Removed and not back yet is a plain removal, other names don't matter.
+        enumerator.setDevices({"/dev/ttyUSB1"});
+        monitor.notifyRemoved("usb-ENTTEC_DMX_USB_PRO-if00");
+        monitor.notifyRemoved("ttyS4");
+        CHECK(rescan(monitor, enumerator));
+        events = monitor.pollEvents();
+        CHECK(events.size() == 1);
+        CHECK(events[0].mType == DeviceMonitor::Event::Removed);
+        CHECK(monitor.getRevision() == revision + 1);
+        monitor.stop();
+    }
+
+    void testStopAndRestart()
+    {
+        FakeEnumerator enumerator;
+        enumerator.setDevices({"/dev/ttyUSB0"});
+        DeviceMonitor monitor([&enumerator]() { return enumerator.enumerate(); });
+        monitor.start();
+        CHECK(rescan(monitor, enumerator));
+        CHECK(monitor.pollEvents().size() == 1);
+        monitor.stop();
+        // Nothing scans while stopped.
+        int scans = enumerator.getScans();
+        monitor.requestRescan();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK(enumerator.getScans() == scans);
+
+        enumerator.setDevices({});
+        monitor.start();
+        CHECK(rescan(monitor, enumerator));
+        auto events = monitor.pollEvents();
+        CHECK(events.size() == 1);
+        CHECK(events[0].mType == DeviceMonitor::Event::Removed && events[0].mDevice == "/dev/ttyUSB0");
+        monitor.stop();
+    }
+}
+
+int main()
+{
+    testArrivalsAndRemovals();
+    testRevisionOnlyChangesWithTheList();
+    testReplugBetweenScans();
+    testStopAndRestart();
+    return check::result();
+}
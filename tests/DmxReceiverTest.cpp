@@ -0,0 +1,127 @@
+//
+//  DmxReceiverTest.cpp
+//  LightControl
+//
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Check.h"
+#include "DmxReceiver.h"
+#include "LoopbackSender.h"
+
+namespace {
+    const int CHANNELS = DmxReceiver::CHANNELS;
+
+    // Waits until the receiver accepted the expected amount of packets, then takes a snapshot.
+    bool waitForPackets(DmxReceiver &receiver, uint64_t count)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (receiver.getPacketCount() < count && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        receiver.update();
+        return receiver.getPacketCount() == count;
+    }
+
+    std::vector<int> merged(DmxReceiver &receiver, int localUniverse)
+    {
+        std::vector<int> values(CHANNELS, 0);
+        receiver.mergeInto(localUniverse, 0, CHANNELS, values.data());
+        return values;
+    }
+
+    void testArtNetMergesSourcesHighestTakesPrecedence()
+    {
+        DmxReceiver receiver(DmxReceiver::Protocol::ArtNet, 2);
+        receiver.subscribe(3, 1);
+        CHECK(receiver.start(0));
+        LoopbackSender first(receiver.getPort());
+        LoopbackSender second(receiver.getPort());
+
+        std::vector<uint8_t> values(CHANNELS, 0);
+        values[0] = 200;
+        values[1] = 10;
+        CHECK(first.send(LoopbackSender::artNetPacket(3, values)));
+        values[0] = 50;
+        values[1] = 100;
+        CHECK(second.send(LoopbackSender::artNetPacket(3, values)));
+        // Not subscribed, dropped before the payload is read.
+        CHECK(first.send(LoopbackSender::artNetPacket(4, std::vector<uint8_t>(CHANNELS, 255))));
+        CHECK(waitForPackets(receiver, 2));
+
+        CHECK(receiver.getSources().size() == 2);
+        std::vector<int> local = merged(receiver, 1);
+        CHECK(local[0] == 200);
+        CHECK(local[1] == 100);
+        CHECK(local[2] == 0);
+        CHECK(merged(receiver, 0)[0] == 0);
+
+        // Received values only raise the local ones.
+        std::vector<int> own(CHANNELS, 150);
+        receiver.mergeInto(1, 0, CHANNELS, own.data());
+        CHECK(own[0] == 200);
+        CHECK(own[2] == 150);
+        receiver.stop();
+    }
+
+    void testSacnPriorityAndSequence()
+    {
+        DmxReceiver receiver(DmxReceiver::Protocol::Sacn, 1);
+        receiver.subscribe(1, 0);
+        CHECK(receiver.start(0));
+        LoopbackSender sender(receiver.getPort());
+
+        std::vector<uint8_t> low(CHANNELS, 0), high(CHANNELS, 0);
+        low[0] = 255;
+        high[0] = 20;
+        CHECK(sender.send(LoopbackSender::sacnPacket(1, low, 1, 100, 10)));
+        CHECK(sender.send(LoopbackSender::sacnPacket(1, high, 2, 150, 10)));
+        CHECK(waitForPackets(receiver, 2));
+        // The higher priority source wins even with lower values.
+        CHECK(merged(receiver, 0)[0] == 20);
+
+        // Out of order for source 2, dropped.
+        high[0] = 99;
+        CHECK(sender.send(LoopbackSender::sacnPacket(1, high, 2, 150, 9)));
+        // Preview data is never used for output.
+        CHECK(sender.send(LoopbackSender::sacnPacket(1, high, 2, 150, 11, 0x80)));
+        high[0] = 30;
+        CHECK(sender.send(LoopbackSender::sacnPacket(1, high, 2, 150, 12)));
+        CHECK(waitForPackets(receiver, 3));
+        CHECK(merged(receiver, 0)[0] == 30);
+
+        // A terminated stream drops the source right away, the lower priority one takes over.
+        CHECK(sender.send(LoopbackSender::sacnPacket(1, high, 2, 150, 13, 0x40)));
+        CHECK(waitForPackets(receiver, 4));
+        CHECK(receiver.getSources().size() == 1);
+        CHECK(merged(receiver, 0)[0] == 255);
+        receiver.stop();
+    }
+
+    void testSourceTimeout()
+    {
+        DmxReceiver receiver(DmxReceiver::Protocol::ArtNet, 1);
+        receiver.subscribe(0, 0);
+        receiver.setSourceTimeout(0.05);
+        CHECK(receiver.start(0));
+        LoopbackSender sender(receiver.getPort());
+        CHECK(sender.send(LoopbackSender::artNetPacket(0, std::vector<uint8_t>(CHANNELS, 80))));
+        CHECK(waitForPackets(receiver, 1));
+        CHECK(merged(receiver, 0)[0] == 80);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        receiver.update();
+        CHECK(receiver.getSources().empty());
+        CHECK(merged(receiver, 0)[0] == 0);
+        receiver.stop();
+    }
+}
+
+int main()
+{
+    testArtNetMergesSourcesHighestTakesPrecedence();
+    testSacnPriorityAndSequence();
+    testSourceTimeout();
+    return check::result();
+}
@@ -0,0 +1,98 @@
+//
+//  FramePipelineTest.cpp
+//  LightControl
+//
+
+#include <algorithm>
+#include <vector>
+#include "Check.h"
+#include "FramePipeline.h"
+
+namespace {
+    const int UNIVERSES = 64;
+
+    std::vector<int> computeFrame(int threadCount, int blockSize)
+    {
+        FramePipeline pipeline(UNIVERSES, threadCount);
+        pipeline.setBlockSize(blockSize);
+        for (int universe = 0; universe < UNIVERSES; universe++) {
+            for (int i = 0; i < FramePipeline::CHANNELS_PER_UNIVERSE; i++) {
+                pipeline.getInput(universe)[i] = (universe * 31 + i * 7) % 256;
+            }
+        }
+        pipeline.addStage("curve", [](int universe, int start, int end, int *values) {
+            for (int i = start; i < end; i++) {
+                values[i] = values[i] * values[i] / 255;
+            }
+        });
+        pipeline.addStage("offset", [](int universe, int start, int end, int *values) {
+            for (int i = start; i < end; i++) {
+                values[i] = std::min(values[i] + universe % 5, 255);
+            }
+        });
+
+        std::vector<int> frame;
+        // Several ticks, so tasks of one tick can't leak into the next one.
+        for (int tick = 0; tick < 20; tick++) {
+            pipeline.process();
+        }
+        for (int universe = 0; universe < UNIVERSES; universe++) {
+            const int *output = pipeline.getOutput(universe);
+            frame.insert(frame.end(), output, output + FramePipeline::CHANNELS_PER_UNIVERSE);
+        }
+        return frame;
+    }
+
+    void testDeterministicAcrossThreadCounts()
+    {
+        const std::vector<int> reference = computeFrame(1, FramePipeline::CHANNELS_PER_UNIVERSE);
+        for (int threads : {1, 2, 4, 8}) {
+            for (int blockSize : {512, 128, 7}) {
+                CHECK(computeFrame(threads, blockSize) == reference);
+            }
+        }
+    }
+
+    void testStagesRunInOrder()
+    {
+        FramePipeline pipeline(1, 2);
+        pipeline.getInput(0)[0] = 10;
+        pipeline.addStage("double", [](int universe, int start, int end, int *values) {
+            for (int i = start; i < end; i++) {
+                values[i] *= 2;
+            }
+        });
+        pipeline.addStage("add", [](int universe, int start, int end, int *values) {
+            for (int i = start; i < end; i++) {
+                values[i] += 1;
+            }
+        });
+        pipeline.process();
+        CHECK(pipeline.getOutput(0)[0] == 21);
+
+        pipeline.removeStage("double");
+        pipeline.process();
+        CHECK(pipeline.getOutput(0)[0] == 11);
+    }
+
+    void testBlockSizeIsClamped()
+    {
+        FramePipeline pipeline(2, 4);
+        pipeline.setBlockSize(0);
+        pipeline.getInput(1)[511] = 42;
+        pipeline.process();
+        CHECK(pipeline.getOutput(1)[511] == 42);
+
+        pipeline.setBlockSize(100000);
+        pipeline.process();
+        CHECK(pipeline.getOutput(1)[511] == 42);
+    }
+}
+
+int main()
+{
+    testDeterministicAcrossThreadCounts();
+    testStagesRunInOrder();
+    testBlockSizeIsClamped();
+    return check::result();
+}
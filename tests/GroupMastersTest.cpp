@@ -0,0 +1,104 @@
+//
+//  GroupMastersTest.cpp
+//  LightControl
+//
+
+#include <vector>
+#include "Check.h"
+#include "GroupMasters.h"
+
+namespace {
+    int apply(GroupMasters &masters, int universe, int channel, int value)
+    {
+        std::vector<int> values(512, 0);
+        values[channel - 1] = value;
+        masters.applyTo(universe, 0, 512, values.data());
+        return values[channel - 1];
+    }
+
+    void testNestedScaling()
+    {
+        GroupMasters masters(1);
+        int stageLeft = masters.addGroup("stage left", -1, GroupMasters::Mode::Scaling);
+        int wash = masters.addGroup("wash", stageLeft, GroupMasters::Mode::Scaling);
+        int fixture = masters.addGroup("fixture", wash, GroupMasters::Mode::Scaling);
+        masters.addChannel(fixture, 0, 1);
+        masters.addChannel(wash, 0, 2);
+
+        CHECK(apply(masters, 0, 1, 200) == 200);
+        masters.setLevel(stageLeft, 0.5f);
+        masters.setLevel(wash, 0.5f);
+        CHECK(apply(masters, 0, 1, 200) == 50);
+        CHECK(apply(masters, 0, 2, 200) == 50);
+        masters.setLevel(fixture, 0.5f);
+        CHECK(apply(masters, 0, 1, 200) == 25);
+        CHECK(apply(masters, 0, 2, 200) == 50);
+        // Channels outside any group are only scaled by the grand master.
+        CHECK(apply(masters, 0, 3, 200) == 200);
+        masters.setGrandMaster(0.5f);
+        CHECK(apply(masters, 0, 3, 200) == 100);
+        CHECK(apply(masters, 0, 1, 200) == 12);
+    }
+
+    void testInhibitiveCaps()
+    {
+        GroupMasters masters(1);
+        int area = masters.addGroup("area", -1, GroupMasters::Mode::Scaling);
+        int wash = masters.addGroup("wash", area, GroupMasters::Mode::Inhibitive);
+        masters.addChannel(wash, 0, 1);
+
+        masters.setLevel(area, 0.8f);
+        masters.setLevel(wash, 0.5f);
+        CHECK(apply(masters, 0, 1, 100) == 50);
+        masters.setLevel(area, 0.25f);
+        CHECK(apply(masters, 0, 1, 100) == 25);
+        // Levels are clamped to 0..1.
+        masters.setLevel(wash, 4.f);
+        CHECK(masters.getLevel(wash) == 1.f);
+        CHECK(apply(masters, 0, 1, 100) == 25);
+    }
+
+    void testChannelInSeveralGroupsTakesLowest()
+    {
+        GroupMasters masters(2);
+        int first = masters.addGroup("first", -1, GroupMasters::Mode::Scaling);
+        int second = masters.addGroup("second", -1, GroupMasters::Mode::Scaling);
+        masters.addChannel(first, 1, 512);
+        masters.addChannel(second, 1, 512);
+        masters.setLevel(first, 0.5f);
+        masters.setLevel(second, 0.75f);
+        CHECK(apply(masters, 1, 512, 200) == 100);
+        masters.setLevel(first, 1.f);
+        CHECK(apply(masters, 1, 512, 200) == 150);
+        CHECK(apply(masters, 0, 512, 200) == 200);
+    }
+
+    void testInvalidInputIsIgnored()
+    {
+        GroupMasters masters(1);
+        int group = masters.addGroup("group", 5, GroupMasters::Mode::Scaling);
+        CHECK(masters.getParent(group) == -1);
+        masters.addChannel(group, 0, 0);
+        masters.addChannel(group, 1, 1);
+        masters.addChannel(7, 0, 1);
+        masters.setLevel(-1, 0.f);
+        masters.setLevel(7, 0.f);
+        masters.setLevel(group, 0.f);
+        CHECK(apply(masters, 0, 1, 100) == 100);
+
+        masters.addChannel(group, 0, 1);
+        CHECK(apply(masters, 0, 1, 100) == 0);
+        masters.clear();
+        CHECK(masters.getGroupCount() == 0);
+        CHECK(apply(masters, 0, 1, 100) == 100);
+    }
+}
+
+int main()
+{
+    testNestedScaling();
+    testInhibitiveCaps();
+    testChannelInSeveralGroupsTakesLowest();
+    testInvalidInputIsIgnored();
+    return check::result();
+}
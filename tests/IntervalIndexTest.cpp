@@ -0,0 +1,86 @@
+//
+//  IntervalIndexTest.cpp
+//  LightControl
+//
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "IntervalIndex.h"
+
+namespace {
+    std::vector<size_t> bruteForce(const std::vector<double> &starts, const std::vector<double> &ends, double time)
+    {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < starts.size(); i++) {
+            if (starts[i] <= time && time < ends[i]) {
+                result.push_back(i);
+            }
+        }
+        return result;
+    }
+
+    std::vector<size_t> query(const IntervalIndex &index, double time)
+    {
+        std::vector<size_t> result;
+        index.query(time, result);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void testMatchesBruteForce()
+    {
+        std::mt19937 random(42);
+        // Whole seconds make shared and touching end points likely.
+        std::uniform_int_distribution<int> start(-50, 1000);
+        std::uniform_int_distribution<int> length(0, 60);
+        std::vector<double> starts, ends;
+        for (int i = 0; i < 20000; i++) {
+            starts.push_back(start(random));
+            ends.push_back(starts.back() + length(random));
+        }
+        IntervalIndex index;
+        index.build(starts, ends);
+        CHECK(index.size() == starts.size());
+
+        int mismatches = 0;
+        for (double time = -60.0; time <= 1070.0; time += 0.5) {
+            if (query(index, time) != bruteForce(starts, ends, time)) {
+                mismatches++;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    void testHalfOpenIntervals()
+    {
+        IntervalIndex index;
+        index.build({1.0, 2.0, 3.0}, {2.0, 2.0, 5.0});
+        CHECK(query(index, 0.5).empty());
+        CHECK(query(index, 1.0) == std::vector<size_t>({0}));
+        // The end is exclusive and empty intervals are never active.
+        CHECK(query(index, 2.0).empty());
+        CHECK(query(index, 4.999) == std::vector<size_t>({2}));
+        CHECK(query(index, 5.0).empty());
+    }
+
+    void testEmptyAndCleared()
+    {
+        IntervalIndex index;
+        CHECK(query(index, 1.0).empty());
+        index.build({0.0}, {10.0});
+        CHECK(query(index, 1.0).size() == 1);
+        index.clear();
+        CHECK(query(index, 1.0).empty());
+        CHECK(index.size() == 0);
+    }
+}
+
+int main()
+{
+    testMatchesBruteForce();
+    testHalfOpenIntervals();
+    testEmptyAndCleared();
+    return check::result();
+}
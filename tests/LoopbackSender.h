@@ -0,0 +1,88 @@
+//
+//  LoopbackSender.h
+//  LightControl
+//
+
+#ifndef LoopbackSender_h
+#define LoopbackSender_h
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Sends Art-Net and sACN packets to a receiver on 127.0.0.1. Every sender has
+// its own socket, so Art-Net receivers see each sender as a separate source.
+class LoopbackSender {
+public:
+    explicit LoopbackSender(int port)
+    :mSocket(socket(AF_INET, SOCK_DGRAM, 0))
+    {
+        std::memset(&mTarget, 0, sizeof(mTarget));
+        mTarget.sin_family = AF_INET;
+        mTarget.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &mTarget.sin_addr);
+    }
+
+    ~LoopbackSender()
+    {
+        close(mSocket);
+    }
+
+    bool send(const std::vector<uint8_t> &packet)
+    {
+        return sendto(mSocket, packet.data(), packet.size(), 0, reinterpret_cast<const sockaddr *>(&mTarget),
+                      sizeof(mTarget)) == (ssize_t) packet.size();
+    }
+
+    static std::vector<uint8_t> artNetPacket(int universe, const std::vector<uint8_t> &values)
+    {
+        std::vector<uint8_t> packet(18 + values.size(), 0);
+        std::memcpy(packet.data(), "Art-Net", 8);
+        packet[8] = 0x00;
+        packet[9] = 0x50;
+        packet[11] = 14;
+        packet[14] = universe & 0xff;
+        packet[15] = (universe >> 8) & 0x7f;
+        packet[16] = (values.size() >> 8) & 0xff;
+        packet[17] = values.size() & 0xff;
+        std::memcpy(packet.data() + 18, values.data(), values.size());
+        return packet;
+    }
+
+    static std::vector<uint8_t> sacnPacket(int universe, const std::vector<uint8_t> &values, uint8_t cid,
+                                           int priority, uint8_t sequence, uint8_t options = 0)
+    {
+        std::vector<uint8_t> packet(126 + values.size(), 0);
+        packet[1] = 0x10;
+        std::memcpy(packet.data() + 4, "ASC-E1.17", 9);
+        packet[21] = 0x04;
+        std::memset(packet.data() + 22, cid, 16);
+        packet[43] = 0x02;
+        std::string name = "Loopback " + std::to_string(cid);
+        std::memcpy(packet.data() + 44, name.c_str(), name.size());
+        packet[108] = priority;
+        packet[111] = sequence;
+        packet[112] = options;
+        packet[113] = (universe >> 8) & 0xff;
+        packet[114] = universe & 0xff;
+        packet[117] = 0x02;
+        packet[118] = 0xa1;
+        packet[122] = 0x01;
+        int count = (int) values.size() + 1;
+        packet[123] = (count >> 8) & 0xff;
+        packet[124] = count & 0xff;
+        std::memcpy(packet.data() + 126, values.data(), values.size());
+        return packet;
+    }
+
+private:
+    int mSocket;
+    sockaddr_in mTarget;
+};
+
+#endif /* LoopbackSender_h */
@@ -0,0 +1,149 @@
+//
+//  ShowTimelineTest.cpp
+//  LightControl
+//
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "ShowTimeline.h"
+
+namespace {
+    const int CHANNELS = 512;
+
+    TimelineEvent event(TimelineEvent::Type type, double start, double end, int channel, float value,
+                        float endValue = 0.f, double period = 1.0, int cue = 0)
+    {
+        TimelineEvent result;
+        result.mType = type;
+        result.mStart = start;
+        result.mEnd = end;
+        result.mUniverse = 0;
+        result.mChannel = channel;
+        result.mValue = value;
+        result.mEndValue = endValue;
+        result.mPeriod = period;
+        result.mCue = cue;
+        return result;
+    }
+
+    // Untouched channels keep -1, so the test can see what the timeline controls.
+    std::vector<int> output(ShowTimeline &timeline, int universe = 0)
+    {
+        std::vector<int> values(CHANNELS, -1);
+        timeline.applyTo(universe, 0, CHANNELS, values.data());
+        return values;
+    }
+
+    void testLatestStartWins()
+    {
+        ShowTimeline timeline(1);
+        timeline.addEvent(event(TimelineEvent::Fader, 0.0, 10.0, 1, 100.f, 0.f, 1.0, 1));
+        timeline.addEvent(event(TimelineEvent::Fader, 2.0, 4.0, 1, 200.f, 0.f, 1.0, 2));
+        // Same start as the first one, added later, so it wins.
+        timeline.addEvent(event(TimelineEvent::Fader, 0.0, 10.0, 2, 10.f));
+        timeline.addEvent(event(TimelineEvent::Fader, 0.0, 10.0, 2, 20.f));
+        timeline.build();
+        CHECK(timeline.getDuration() == 10.0);
+
+        timeline.evaluate(1.0);
+        CHECK(output(timeline)[0] == 100);
+        CHECK(output(timeline)[1] == 20);
+        CHECK(timeline.getActiveCue() == 1);
+        timeline.evaluate(3.0);
+        CHECK(output(timeline)[0] == 200);
+        CHECK(timeline.getActiveCue() == 2);
+        CHECK(timeline.getActiveEventCount() == 4);
+        timeline.evaluate(4.0);
+        CHECK(output(timeline)[0] == 100);
+    }
+
+    void testFadeAndEffectValues()
+    {
+        ShowTimeline timeline(1);
+        timeline.addEvent(event(TimelineEvent::Fade, 10.0, 20.0, 5, 0.f, 200.f));
+        timeline.addEvent(event(TimelineEvent::Effect, 0.0, 100.0, 6, 0.f, 255.f, 4.0));
+        timeline.build();
+
+        timeline.evaluate(15.0);
+        CHECK(output(timeline)[4] == 100);
+        // A quarter of the period in, the sine is half way.
+        CHECK(output(timeline)[5] == 128);
+        timeline.evaluate(42.0);
+        CHECK(output(timeline)[5] == 255);
+        timeline.evaluate(44.0);
+        CHECK(output(timeline)[5] == 0);
+    }
+
+    void testSeekReleasesChannels()
+    {
+        ShowTimeline timeline(2);
+        TimelineEvent second = event(TimelineEvent::Fader, 5.0, 6.0, 512, 77.f);
+        second.mUniverse = 1;
+        timeline.addEvent(second);
+        // Out of range, ignored.
+        TimelineEvent invalid = event(TimelineEvent::Fader, 0.0, 100.0, 513, 1.f);
+        timeline.addEvent(invalid);
+        timeline.build();
+        CHECK(timeline.getEventCount() == 1);
+
+        timeline.evaluate(5.5);
+        CHECK(output(timeline, 1)[511] == 77);
+        CHECK(output(timeline, 0)[511] == -1);
+        // Seeking away leaves the channel to the rest of the pipeline again.
+        timeline.evaluate(7.0);
+        CHECK(output(timeline, 1)[511] == -1);
+        CHECK(timeline.getActiveEventCount() == 0);
+    }
+
+    void testSeekMatchesBruteForce()
+    {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> start(0.0, 600.0);
+        std::uniform_real_distribution<double> length(0.1, 30.0);
+        std::uniform_int_distribution<int> channel(1, CHANNELS);
+        std::uniform_int_distribution<int> value(0, 255);
+        std::vector<TimelineEvent> events;
+        ShowTimeline timeline(1);
+        for (int i = 0; i < 100000; i++) {
+            double eventStart = start(random);
+            events.push_back(event(TimelineEvent::Fader, eventStart, eventStart + length(random), channel(random),
+                                   (float) value(random)));
+            timeline.addEvent(events.back());
+        }
+        timeline.build();
+
+        // Jump around, every seek must only depend on the time, not on the previous position.
+        std::uniform_real_distribution<double> seek(-10.0, 640.0);
+        int mismatches = 0;
+        for (int i = 0; i < 50; i++) {
+            double time = seek(random);
+            timeline.evaluate(time);
+            std::vector<int> expected(CHANNELS, -1);
+            std::vector<double> winnerStart(CHANNELS, 0.0);
+            for (auto &candidate : events) {
+                if (candidate.mStart <= time && time < candidate.mEnd) {
+                    int slot = candidate.mChannel - 1;
+                    if (expected[slot] < 0 || candidate.mStart >= winnerStart[slot]) {
+                        expected[slot] = (int) candidate.mValue;
+                        winnerStart[slot] = candidate.mStart;
+                    }
+                }
+            }
+            if (output(timeline) != expected) {
+                mismatches++;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+int main()
+{
+    testLatestStartWins();
+    testFadeAndEffectValues();
+    testSeekReleasesChannels();
+    testSeekMatchesBruteForce();
+    return check::result();
+}
@@ -0,0 +1,214 @@
+//
+//  TimecodeClockTest.cpp
+//  LightControl
+//
+
+#include <cmath>
+#include <vector>
+#include "Check.h"
+#include "TimecodeClock.h"
+
+namespace {
+    typedef TimecodeClock::Clock Clock;
+
+    const double TOLERANCE = 1e-9;
+
+    Clock::time_point at(Clock::time_point start, double seconds)
+    {
+        return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    // Simulated midi timecode source, sends the quarter frames of a running transport.
+    class MtcSource {
+    public:
+        MtcSource(int hours, int minutes, int seconds, int frames, int rateBits, double frameRate)
+        :mHours(hours), mMinutes(minutes), mSeconds(seconds), mFrames(frames), mRateBits(rateBits),
+         mFrameRate(frameRate), mFramesPerSecond((int) std::round(frameRate)), mQuarterFrame(0)
+        {
+        }
+
+        // Sends the next quarter frame and returns the time it was sent, relative to the first one.
+        double sendQuarterFrame(TimecodeClock &clock, Clock::time_point start)
+        {
+            int piece = mQuarterFrame % 8;
+            // Every cycle of eight quarter frames carries the timecode of the frame it started on,
+            // two frames after the previous one.
+            if (piece == 0 && mQuarterFrame > 0) {
+                advanceFrame();
+                advanceFrame();
+            }
+            int values[8] = {
+                mFrames & 0x0f, mFrames >> 4, mSeconds & 0x0f, mSeconds >> 4,
+                mMinutes & 0x0f, mMinutes >> 4, mHours & 0x0f, (mHours >> 4) | (mRateBits << 1)
+            };
+            double sent = mQuarterFrame / (mFrameRate * 4.0);
+            unsigned char message[2] = {0xf1, (unsigned char) ((piece << 4) | values[piece])};
+            clock.receiveMidi(message, 2, at(start, sent));
+            mQuarterFrame++;
+            return sent;
+        }
+
+    private:
+        int mHours, mMinutes, mSeconds, mFrames, mRateBits;
+        double mFrameRate;
+        int mFramesPerSecond;
+        int mQuarterFrame;
+
+        void advanceFrame()
+        {
+            if (++mFrames < mFramesPerSecond) {
+                return;
+            }
+            mFrames = 0;
+            if (++mSeconds < 60) {
+                return;
+            }
+            mSeconds = 0;
+            if (++mMinutes == 60) {
+                mMinutes = 0;
+                mHours++;
+            }
+            // Drop frame skips frames 0 and 1 at the start of every minute except every tenth.
+            if (mRateBits == 2 && mMinutes % 10 != 0) {
+                mFrames = 2;
+            }
+        }
+    };
+
+    void sendFullFrame(TimecodeClock &clock, int hours, int minutes, int seconds, int frames, int rateBits,
+                       Clock::time_point when)
+    {
+        unsigned char message[10] = {
+            0xf0, 0x7f, 0x7f, 0x01, 0x01, (unsigned char) ((rateBits << 5) | hours),
+            (unsigned char) minutes, (unsigned char) seconds, (unsigned char) frames, 0xf7
+        };
+        clock.receiveMidi(message, 10, when);
+    }
+
+    void testQuarterFramesTrackTheSource()
+    {
+        TimecodeClock clock;
+        auto start = Clock::now();
+        // Runs from 01:02:59:10 across the next second and minute.
+        MtcSource source(1, 2, 59, 10, 1, 25.0);
+        const double position = 3779.0 + 10.0 / 25.0;
+
+        // Nothing is known before the first full cycle.
+        for (int i = 0; i < 7; i++) {
+            source.sendQuarterFrame(clock, start);
+        }
+        CHECK(!clock.isRolling(at(start, 0.07)));
+
+        for (int i = 7; i < 8 * 10; i++) {
+            double sent = source.sendQuarterFrame(clock, start);
+            CHECK_NEAR(clock.getTime(at(start, sent)), position + sent, TOLERANCE);
+            // Half a quarter frame later the clock has moved on by exactly that much.
+            CHECK_NEAR(clock.getTime(at(start, sent + 0.005)), position + sent + 0.005, TOLERANCE);
+        }
+        CHECK(clock.isRolling(at(start, 0.8)));
+        CHECK_NEAR(clock.getFrameRate(), 25.0, TOLERANCE);
+    }
+
+    void testExtrapolationIsCappedAndTimesOut()
+    {
+        TimecodeClock clock;
+        auto start = Clock::now();
+        MtcSource source(0, 0, 10, 0, 3, 30.0);
+        double sent = 0.0;
+        for (int i = 0; i < 16; i++) {
+            sent = source.sendQuarterFrame(clock, start);
+        }
+        const double last = 10.0 + sent;
+        const double quarterFrame = 1.0 / 120.0;
+
+        // The clock never runs more than one quarter frame ahead of the last message.
+        CHECK_NEAR(clock.getTime(at(start, sent + 0.05)), last + quarterFrame, TOLERANCE);
+        CHECK(clock.isRolling(at(start, sent + 0.05)));
+        // After the timeout the transport is considered stopped and the position holds.
+        CHECK(!clock.isRolling(at(start, sent + 0.15)));
+        CHECK_NEAR(clock.getTime(at(start, sent + 5.0)), last + quarterFrame, TOLERANCE);
+    }
+
+    void testFullFrameLocates()
+    {
+        TimecodeClock clock;
+        auto start = Clock::now();
+        sendFullFrame(clock, 1, 0, 0, 12, 0, start);
+        CHECK_NEAR(clock.getTime(start), 3600.5, TOLERANCE);
+        CHECK_NEAR(clock.getFrameRate(), 24.0, TOLERANCE);
+        // A locate is not rolling, so the position doesn't move.
+        CHECK(!clock.isRolling(at(start, 0.01)));
+        CHECK_NEAR(clock.getTime(at(start, 2.0)), 3600.5, TOLERANCE);
+    }
+
+    void testDropFrame()
+    {
+        const double rate = 30000.0 / 1001.0;
+        TimecodeClock clock;
+        auto start = Clock::now();
+
+        // Frames 0 and 1 don't exist at the start of a minute, so 00:01:00;02 is frame 1800.
+        sendFullFrame(clock, 0, 1, 0, 2, 2, start);
+        CHECK_NEAR(clock.getTime(start), 1800.0 / rate, TOLERANCE);
+        // Every tenth minute keeps them: 00:10:00;00 is frame 17982.
+        sendFullFrame(clock, 0, 10, 0, 0, 2, start);
+        CHECK_NEAR(clock.getTime(start), 17982.0 / rate, TOLERANCE);
+
+        MtcSource source(0, 1, 0, 2, 2, rate);
+        double sent = 0.0;
+        for (int i = 0; i < 8; i++) {
+            sent = source.sendQuarterFrame(clock, start);
+        }
+        CHECK_NEAR(clock.getTime(at(start, sent)), 1800.0 / rate + sent, TOLERANCE);
+        CHECK_NEAR(clock.getFrameRate(), rate, TOLERANCE);
+
+        // Quarter frames from 00:00:59;28 jump to 00:01:00;02 at the minute without a gap in time.
+        TimecodeClock rolling;
+        MtcSource crossing(0, 0, 59, 28, 2, rate);
+        for (int i = 0; i < 8 * 4; i++) {
+            sent = crossing.sendQuarterFrame(rolling, start);
+            if (i >= 7) {
+                CHECK_NEAR(rolling.getTime(at(start, sent)), 1798.0 / rate + sent, TOLERANCE);
+            }
+        }
+    }
+
+    void testExternalClock()
+    {
+        TimecodeClock clock;
+        auto start = Clock::now();
+        clock.receivePosition(10.0, true, start);
+        CHECK_NEAR(clock.getTime(at(start, 0.2)), 10.2, TOLERANCE);
+        CHECK(clock.isRolling(at(start, 0.2)));
+        // Capped at the timeout when the updates stop.
+        CHECK_NEAR(clock.getTime(at(start, 3.0)), 10.5, TOLERANCE);
+        CHECK(!clock.isRolling(at(start, 0.6)));
+
+        clock.receivePosition(5.0, false, at(start, 3.0));
+        CHECK_NEAR(clock.getTime(at(start, 4.0)), 5.0, TOLERANCE);
+        CHECK(!clock.isRolling(at(start, 3.0)));
+    }
+
+    void testOtherMessagesAreIgnored()
+    {
+        TimecodeClock clock;
+        auto start = Clock::now();
+        clock.receivePosition(1.0, false, start);
+        unsigned char noteOn[3] = {0x90, 60, 100};
+        clock.receiveMidi(noteOn, 3, start);
+        unsigned char clockTick[1] = {0xf8};
+        clock.receiveMidi(clockTick, 1, start);
+        CHECK_NEAR(clock.getTime(start), 1.0, TOLERANCE);
+    }
+}
+
+int main()
+{
+    testQuarterFramesTrackTheSource();
+    testExtrapolationIsCappedAndTimesOut();
+    testFullFrameLocates();
+    testDropFrame();
+    testExternalClock();
+    testOtherMessagesAreIgnored();
+    return check::result();
+}